@@ -0,0 +1,85 @@
+#pragma once
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+/**
+ * Counts the heap allocations of a benchmark executable by replacing the global operator new, so a benchmark can check
+ * that its measured code does not allocate in steady state. Replaced allocation functions must not be inline, so this
+ * header must be included by exactly one translation unit of an executable.
+ */
+namespace TerminalMinigames::Bench
+{
+	/**
+	 * Number of heap allocations done by the process so far. Counted by the replaced global operator new.
+	 */
+	inline std::atomic<long> allocation_count = 0;
+
+	/**
+	 * Command line of a benchmark checking for allocations: [--check-allocations] [ticks per run]
+	 */
+	struct AllocationBenchmarkOptions
+	{
+		/**
+		 * Whether the benchmark fails if any measured tick allocated heap memory.
+		 */
+		bool check_allocations = false;
+		long ticks = 0;
+	};
+
+	inline AllocationBenchmarkOptions ParseAllocationBenchmarkOptions(int argc, char** argv, long default_ticks)
+	{
+		AllocationBenchmarkOptions options;
+		options.ticks = default_ticks;
+		for (int index = 1; index < argc; ++index)
+		{
+			if (std::strcmp(argv[index], "--check-allocations") == 0)
+			{
+				options.check_allocations = true;
+			}
+			else
+			{
+				options.ticks = std::atol(argv[index]);
+			}
+		}
+		return options;
+	}
+
+	/**
+	 * Reports the failure if allocations are checked and any measured tick allocated.
+	 *
+	 * @returns Exit code of the benchmark.
+	 */
+	inline int AllocationCheckResult(const AllocationBenchmarkOptions& options, bool allocated)
+	{
+		if (options.check_allocations && allocated)
+		{
+			std::printf("FAILED: the simulation allocated heap memory in steady state\n");
+			return EXIT_FAILURE;
+		}
+		return EXIT_SUCCESS;
+	}
+}
+
+void* operator new(std::size_t size)
+{
+	TerminalMinigames::Bench::allocation_count.fetch_add(1, std::memory_order_relaxed);
+	if (void* memory = std::malloc(size == 0 ? 1 : size))
+	{
+		return memory;
+	}
+	throw std::bad_alloc();
+}
+
+void operator delete(void* memory) noexcept
+{
+	std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept
+{
+	std::free(memory);
+}
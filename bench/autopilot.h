@@ -0,0 +1,81 @@
+#pragma once
+
+#include "block_breaker_simulation.h"
+#include "snake_simulation.h"
+#include "util/input_direction.h"
+
+namespace TerminalMinigames::Bench
+{
+	/**
+	 * Steers the snake towards a food cell, turning whenever the food is to its side.
+	 */
+	inline InputDirection NextSnakeTurn(const Snake::SnakeSimulation& simulation)
+	{
+		const auto& state = simulation.State();
+		if (state.food_positions.empty())
+		{
+			return InputDirection::None;
+		}
+
+		const Snake::SnakeConfig& config = simulation.Config();
+		Snake::Cell head = state.snake_position_queue.Front();
+		Snake::Cell food = *state.food_positions.begin();
+
+		int dx = config.CellX(food) - config.CellX(head);
+		int dy = config.CellY(food) - config.CellY(head);
+		for (auto direction : { dx < 0 ? InputDirection::Left : InputDirection::Right,
+			dy < 0 ? InputDirection::Up : InputDirection::Down })
+		{
+			bool towards_food = (direction == InputDirection::Left || direction == InputDirection::Right) ? dx != 0 : dy != 0;
+			if (towards_food && simulation.IsTurn(direction))
+			{
+				return direction;
+			}
+		}
+		return InputDirection::None;
+	}
+
+	/**
+	 * Moves the paddle towards the ball to keep rallies going.
+	 */
+	inline void FollowBall(BlockBreaker::BlockBreakerSimulation& simulation)
+	{
+		const auto& state = simulation.State();
+		if (state.ball_position.x < state.paddle_position.x - 1)
+		{
+			simulation.MovePaddle(InputDirection::Left);
+		}
+		else if (state.ball_position.x > state.paddle_position.x + 1)
+		{
+			simulation.MovePaddle(InputDirection::Right);
+		}
+	}
+
+	/**
+	 * Snake configuration with a board of the given size in canvas pixels.
+	 */
+	inline Snake::SnakeConfig SnakeConfigForBoard(int width, int height)
+	{
+		Snake::SnakeConfig config;
+		config.board_dimension_x = width;
+		config.board_dimension_y = height;
+		config.max_x_dimension = width - 4;
+		config.max_y_dimension = height - 4;
+		return config;
+	}
+
+	/**
+	 * Block Breaker configuration with a board of the given size in canvas pixels.
+	 */
+	inline BlockBreaker::BlockBreakerConfig BlockBreakerConfigForBoard(int width, int height)
+	{
+		BlockBreaker::BlockBreakerConfig config;
+		if (width != config.board_dimension_x || height != config.board_dimension_y)
+		{
+			config.board_dimension_x = width;
+			config.board_dimension_y = height;
+			config.paddle_start_position = { static_cast<double>(width / 2), static_cast<double>(height - 12) };
+		}
+		return config;
+	}
+}
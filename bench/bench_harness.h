@@ -0,0 +1,275 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <istream>
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace TerminalMinigames::Bench
+{
+	/**
+	 * Keeps the compiler from optimizing away the computation of the given value.
+	 */
+	template <typename T>
+	inline void DoNotOptimize(const T& value)
+	{
+#if defined(_MSC_VER)
+		static const void* volatile sink;
+		sink = &value;
+		_ReadWriteBarrier();
+#else
+		asm volatile("" : : "r,m"(value) : "memory");
+#endif
+	}
+
+	/**
+	 * Runs the measured operation the given number of times.
+	 */
+	using BenchmarkFunction = std::function<void(long iterations)>;
+
+	struct BenchmarkOptions
+	{
+		/**
+		 * Only benchmarks whose name contains this text are run.
+		 */
+		std::string filter;
+		int repetitions = 10;
+		/**
+		 * Time each benchmark runs unmeasured before its repetitions, to fill caches and reach steady-state storage sizes.
+		 */
+		double warmup_ms = 100.0;
+		/**
+		 * Minimum duration of one repetition. The number of iterations per repetition is chosen to reach it, so that
+		 * the clock's resolution does not distort the measurement of fast operations.
+		 */
+		double min_repetition_ms = 20.0;
+	};
+
+	/**
+	 * Statistics of a benchmark's repetitions, in nanoseconds per iteration.
+	 */
+	struct BenchmarkResult
+	{
+		std::string name;
+		long iterations = 0;
+		int repetitions = 0;
+		double mean_ns = 0.0;
+		double median_ns = 0.0;
+		double stddev_ns = 0.0;
+		double min_ns = 0.0;
+		double max_ns = 0.0;
+	};
+
+	/**
+	 * Set of named benchmarks that are calibrated, warmed up and repeated.
+	 */
+	class BenchmarkSuite
+	{
+	public:
+		void Add(std::string name, BenchmarkFunction function)
+		{
+			benchmarks.push_back({ std::move(name), std::move(function) });
+		}
+
+		/**
+		 * Runs all benchmarks matching the options' filter and reports each result to the given stream as it is done.
+		 */
+		std::vector<BenchmarkResult> Run(const BenchmarkOptions& options, std::ostream& progress) const
+		{
+			std::vector<BenchmarkResult> results;
+			for (const auto& benchmark : benchmarks)
+			{
+				if (benchmark.name.find(options.filter) == std::string::npos)
+				{
+					continue;
+				}
+
+				results.push_back(RunBenchmark(benchmark, options));
+				const BenchmarkResult& result = results.back();
+				progress << result.name << ": median " << result.median_ns << " ns, mean " << result.mean_ns << " ns +- "
+					<< result.stddev_ns << ", min " << result.min_ns << ", max " << result.max_ns << " ("
+					<< result.repetitions << " x " << result.iterations << " iterations)\n";
+			}
+			return results;
+		}
+
+	private:
+		struct Benchmark
+		{
+			std::string name;
+			BenchmarkFunction function;
+		};
+
+		using Clock = std::chrono::steady_clock;
+
+		static double RunMilliseconds(const Benchmark& benchmark, long iterations)
+		{
+			auto start = Clock::now();
+			benchmark.function(iterations);
+			return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+		}
+
+		static BenchmarkResult RunBenchmark(const Benchmark& benchmark, const BenchmarkOptions& options)
+		{
+			// Double the iterations until a run is long enough to be measured, then scale to the repetition length
+			long iterations = 1;
+			double elapsed_ms = RunMilliseconds(benchmark, iterations);
+			while (elapsed_ms < options.min_repetition_ms / 8.0 && iterations < (1L << 40))
+			{
+				iterations *= 2;
+				elapsed_ms = RunMilliseconds(benchmark, iterations);
+			}
+			if (elapsed_ms < options.min_repetition_ms)
+			{
+				iterations = static_cast<long>(std::ceil(iterations * options.min_repetition_ms / std::max(elapsed_ms, 1e-3)));
+			}
+
+			auto warmup_end = Clock::now() + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double, std::milli>(options.warmup_ms));
+			while (Clock::now() < warmup_end)
+			{
+				benchmark.function(iterations);
+			}
+
+			std::vector<double> samples_ns;
+			for (int repetition = 0; repetition < std::max(options.repetitions, 1); ++repetition)
+			{
+				samples_ns.push_back(RunMilliseconds(benchmark, iterations) * 1e6 / static_cast<double>(iterations));
+			}
+
+			BenchmarkResult result;
+			result.name = benchmark.name;
+			result.iterations = iterations;
+			result.repetitions = static_cast<int>(samples_ns.size());
+
+			std::sort(samples_ns.begin(), samples_ns.end());
+			size_t middle = samples_ns.size() / 2;
+			result.median_ns = samples_ns.size() % 2 == 1 ? samples_ns[middle] : (samples_ns[middle - 1] + samples_ns[middle]) / 2.0;
+			result.min_ns = samples_ns.front();
+			result.max_ns = samples_ns.back();
+
+			for (double sample : samples_ns)
+			{
+				result.mean_ns += sample;
+			}
+			result.mean_ns /= static_cast<double>(samples_ns.size());
+
+			double squared_deviations = 0.0;
+			for (double sample : samples_ns)
+			{
+				squared_deviations += (sample - result.mean_ns) * (sample - result.mean_ns);
+			}
+			result.stddev_ns = samples_ns.size() > 1 ? std::sqrt(squared_deviations / static_cast<double>(samples_ns.size() - 1)) : 0.0;
+
+			return result;
+		}
+
+		std::vector<Benchmark> benchmarks;
+	};
+
+	/**
+	 * Writes the results as JSON with one benchmark object per line, which is the format ReadBaseline() expects.
+	 */
+	inline void WriteJson(std::ostream& output, const std::vector<BenchmarkResult>& results)
+	{
+		auto quoted = [](const std::string& text)
+			{
+				std::string escaped = "\"";
+				for (char character : text)
+				{
+					if (character == '"' || character == '\\')
+					{
+						escaped += '\\';
+					}
+					escaped += character;
+				}
+				return escaped + "\"";
+			};
+
+		output << "{\n  \"benchmarks\": [\n";
+		for (size_t index = 0; index < results.size(); ++index)
+		{
+			const BenchmarkResult& result = results[index];
+			output << "    { \"name\": " << quoted(result.name)
+				<< ", \"iterations\": " << result.iterations
+				<< ", \"repetitions\": " << result.repetitions
+				<< ", \"median_ns\": " << result.median_ns
+				<< ", \"mean_ns\": " << result.mean_ns
+				<< ", \"stddev_ns\": " << result.stddev_ns
+				<< ", \"min_ns\": " << result.min_ns
+				<< ", \"max_ns\": " << result.max_ns
+				<< " }" << (index + 1 < results.size() ? "," : "") << '\n';
+		}
+		output << "  ]\n}\n";
+	}
+
+	/**
+	 * Reads the median of every benchmark from a file written by WriteJson().
+	 *
+	 * @returns Median nanoseconds per iteration by benchmark name.
+	 */
+	inline std::map<std::string, double> ReadBaseline(std::istream& input)
+	{
+		std::map<std::string, double> medians;
+
+		std::string line;
+		while (std::getline(input, line))
+		{
+			auto name_key = line.find("\"name\": \"");
+			auto median_key = line.find("\"median_ns\": ");
+			if (name_key == std::string::npos || median_key == std::string::npos)
+			{
+				continue;
+			}
+
+			std::string name;
+			for (size_t position = name_key + 9; position < line.size() && line[position] != '"'; ++position)
+			{
+				if (line[position] == '\\' && position + 1 < line.size())
+				{
+					++position;
+				}
+				name += line[position];
+			}
+			medians[name] = std::stod(line.substr(median_key + 13));
+		}
+		return medians;
+	}
+
+	/**
+	 * Prints how each result's median changed compared to the baseline.
+	 *
+	 * @param threshold_percent Slowdown above which a benchmark counts as regressed.
+	 * @returns Number of regressed benchmarks.
+	 */
+	inline int CompareWithBaseline(std::ostream& output, const std::vector<BenchmarkResult>& results,
+		const std::map<std::string, double>& baseline, double threshold_percent)
+	{
+		int regressions = 0;
+		for (const BenchmarkResult& result : results)
+		{
+			auto entry = baseline.find(result.name);
+			if (entry == baseline.end() || entry->second <= 0.0)
+			{
+				output << result.name << ": not in baseline\n";
+				continue;
+			}
+
+			double change_percent = (result.median_ns / entry->second - 1.0) * 100.0;
+			bool regressed = change_percent > threshold_percent;
+			regressions += regressed;
+
+			output << result.name << ": " << entry->second << " ns -> " << result.median_ns << " ns ("
+				<< (change_percent >= 0.0 ? "+" : "") << change_percent << "%)" << (regressed ? "  REGRESSION" : "") << '\n';
+		}
+		return regressions;
+	}
+}
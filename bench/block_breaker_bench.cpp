@@ -0,0 +1,140 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "allocation_counter.h"
+#include "autopilot.h"
+#include "block_breaker_simulation.h"
+
+using namespace TerminalMinigames;
+using namespace TerminalMinigames::BlockBreaker;
+
+namespace
+{
+	/**
+	 * Level to benchmark the simulation with.
+	 */
+	struct BenchmarkLevel
+	{
+		std::string name;
+		int rows;
+		int columns;
+	};
+
+	/**
+	 * Fixed time step the benchmark advances the simulation by, equal to the game's physics rate.
+	 */
+	constexpr double time_step = 1.0 / 240.0;
+
+	/**
+	 * Creates a configuration with a board that is large enough to hold the given level.
+	 */
+	BlockBreakerConfig CreateConfig(const BenchmarkLevel& level, OverlapKernel kernel)
+	{
+		BlockBreakerConfig config;
+		config.overlap_kernel = kernel;
+		if (level.columns > 12 || level.rows > 3)
+		{
+			config.board_dimension_x = std::max(config.board_dimension_x, 8 * level.columns + 10);
+			config.board_dimension_y = std::max(config.board_dimension_y, 6 * level.rows + 100);
+			config.paddle_start_position = { static_cast<double>(config.board_dimension_x / 2), static_cast<double>(config.board_dimension_y - 12) };
+		}
+		return config;
+	}
+
+	/**
+	 * Result of running a level.
+	 */
+	struct LevelResult
+	{
+		double ticks_per_second;
+		/**
+		 * Heap allocations done while running the measured ticks.
+		 */
+		long allocations;
+	};
+
+	/**
+	 * Advances the simulation by one tick. The paddle follows the ball to keep rallies going.
+	 * A new game is started whenever the current one ends.
+	 */
+	void Tick(BlockBreakerSimulation& simulation, const std::vector<Block>& blocks)
+	{
+		Bench::FollowBall(simulation);
+		simulation.Step(time_step);
+
+		if (simulation.IsOver())
+		{
+			simulation.Reset(blocks);
+		}
+	}
+
+	/**
+	 * Runs the given number of ticks on the given level after a warmup that lets all storage reach its steady-state size.
+	 */
+	LevelResult RunLevel(const BenchmarkLevel& level, OverlapKernel kernel, long ticks)
+	{
+		BlockBreakerSimulation simulation(CreateConfig(level, kernel));
+		auto blocks = CreateLevel(level.rows, level.columns);
+		simulation.Reset(blocks);
+
+		for (long tick = 0; tick < ticks / 10; ++tick)
+		{
+			Tick(simulation, blocks);
+		}
+
+		long allocations_before = Bench::allocation_count.load();
+		auto start = std::chrono::steady_clock::now();
+		for (long tick = 0; tick < ticks; ++tick)
+		{
+			Tick(simulation, blocks);
+		}
+		std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+		return { ticks / elapsed.count(), Bench::allocation_count.load() - allocations_before };
+	}
+}
+
+/**
+ * Reports how many ticks per second the Block Breaker simulation achieves for the default level and larger stress levels
+ * with every overlap kernel the CPU supports.
+ * With --check-allocations the benchmark fails if any measured tick allocated heap memory.
+ * Usage: blockBreakerBench [--check-allocations] [ticks per level]
+ */
+int main(int argc, char** argv)
+{
+	Bench::AllocationBenchmarkOptions options = Bench::ParseAllocationBenchmarkOptions(argc, argv, 200000);
+
+	std::vector<BenchmarkLevel> levels = {
+		{ "default", 3, 12 },
+		{ "stress-1k", 20, 50 },
+		{ "stress-5k", 50, 100 },
+		{ "stress-20k", 100, 200 }
+	};
+
+	std::vector<OverlapKernel> kernels;
+	for (auto kernel : { OverlapKernel::Scalar, OverlapKernel::Sse2, OverlapKernel::Avx2 })
+	{
+		if (IsOverlapKernelSupported(kernel))
+		{
+			kernels.push_back(kernel);
+		}
+	}
+
+	bool allocated = false;
+	for (const auto& level : levels)
+	{
+		for (auto kernel : kernels)
+		{
+			LevelResult result = RunLevel(level, kernel, options.ticks);
+			std::printf("%-12s %6d blocks  %-6s %10.0f ticks/s  %ld allocations\n",
+				level.name.c_str(), level.rows * level.columns, ToString(kernel).c_str(), result.ticks_per_second, result.allocations);
+
+			allocated = allocated || result.allocations != 0;
+		}
+	}
+
+	return Bench::AllocationCheckResult(options, allocated);
+}
@@ -0,0 +1,267 @@
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "ftxui/dom/canvas.hpp"
+#include "ftxui/dom/elements.hpp"
+
+#include "autopilot.h"
+#include "block_breaker.h"
+#include "block_breaker_simulation.h"
+#include "offscreen_renderer.h"
+#include "snake_game.h"
+#include "snake_simulation.h"
+
+using namespace TerminalMinigames;
+using namespace TerminalMinigames::Bench;
+
+namespace
+{
+	struct BoardSize
+	{
+		int width = 0;
+		int height = 0;
+	};
+
+	struct RunOptions
+	{
+		std::string game = "all";
+		/**
+		 * Board sizes in canvas pixels. Empty to run each game at its own size and at two and four times that size.
+		 */
+		std::vector<BoardSize> sizes;
+		int frames = 1000;
+		std::string golden_dir;
+		bool update_golden = false;
+	};
+
+	bool ParseSizes(const std::string& text, std::vector<BoardSize>& sizes)
+	{
+		std::istringstream list(text);
+		std::string entry;
+		while (std::getline(list, entry, ','))
+		{
+			BoardSize size;
+			char separator = 0;
+			std::istringstream parser(entry);
+			if (!(parser >> size.width >> separator >> size.height) || separator != 'x' || size.width < 20 || size.height < 20)
+			{
+				return false;
+			}
+			sizes.push_back(size);
+		}
+		return !sizes.empty();
+	}
+
+	std::vector<BoardSize> SizesFor(const RunOptions& options, int default_width, int default_height)
+	{
+		if (!options.sizes.empty())
+		{
+			return options.sizes;
+		}
+		return { { default_width, default_height }, { 2 * default_width, 2 * default_height }, { 4 * default_width, 4 * default_height } };
+	}
+
+	/**
+	 * Compares the final frame with its golden frame, or writes it as new golden frame.
+	 *
+	 * @returns Whether the frame matches or the golden frame was written.
+	 */
+	bool CheckGolden(const RunOptions& options, OffscreenRenderer& renderer, const std::string& name)
+	{
+		if (options.golden_dir.empty())
+		{
+			return true;
+		}
+
+		std::filesystem::path path = std::filesystem::path(options.golden_dir) / (name + ".txt");
+		if (options.update_golden)
+		{
+			std::filesystem::create_directories(path.parent_path());
+			std::ofstream golden(path);
+			renderer.WriteGolden(golden);
+			std::cout << "  wrote golden frame " << path.string() << '\n';
+			return static_cast<bool>(golden);
+		}
+
+		std::ifstream golden(path);
+		if (!golden)
+		{
+			std::cout << "  FAILED: no golden frame " << path.string() << " (run with --update-golden to create it)\n";
+			return false;
+		}
+
+		GoldenComparison comparison = renderer.CompareWithGolden(golden);
+		if (!comparison.matches)
+		{
+			std::cout << "  FAILED: frame differs from " << path.string() << " at line " << comparison.first_different_line << '\n'
+				<< "    expected: " << comparison.expected_line << '\n'
+				<< "    actual:   " << comparison.actual_line << '\n';
+			return false;
+		}
+		std::cout << "  matches golden frame " << path.string() << '\n';
+		return true;
+	}
+
+	void Report(const std::string& name, OffscreenRenderer& renderer)
+	{
+		const FrameStats& totals = renderer.OutputTotals();
+		double frames = static_cast<double>(std::max<size_t>(renderer.Frames(), 1));
+		std::cout << name << ": " << renderer.Frames() << " frames, " << std::fixed << std::setprecision(0)
+			<< renderer.FramesPerSecond() << " frames/s, " << std::setprecision(1)
+			<< static_cast<double>(totals.bytes_written) / frames << " bytes/frame, "
+			<< static_cast<double>(totals.cells_changed) / frames << " cells changed/frame, "
+			<< renderer.FrameText().size() << " bytes full frame\n" << std::defaultfloat;
+	}
+
+	/**
+	 * Plays a seeded Snake game with the autopilot for the given number of frames, one tick per frame, and renders
+	 * every frame offscreen.
+	 */
+	bool RunSnake(const RunOptions& options, BoardSize size)
+	{
+		Snake::SnakeConfig config = SnakeConfigForBoard(size.width, size.height);
+		Snake::SnakeSimulation simulation(config, 1);
+		Snake::BoardCanvas board(config);
+		Snake::SnakeSnapshot snapshot;
+		OffscreenRenderer renderer((size.width + 1) / 2, (size.height + 3) / 4);
+
+		std::uint64_t game = 1;
+		for (int frame = 0; frame < options.frames; ++frame)
+		{
+			if (simulation.IsOver())
+			{
+				simulation.Reset(NextGameSeed(simulation.Seed()));
+				++game;
+			}
+			simulation.Step(NextSnakeTurn(simulation));
+
+			Snake::CaptureSnapshot(simulation, game, snapshot);
+			renderer.Render(ftxui::canvas(&board.Update(snapshot)));
+		}
+
+		std::string name = "snake_" + std::to_string(size.width) + "x" + std::to_string(size.height);
+		Report(name, renderer);
+		return CheckGolden(options, renderer, name);
+	}
+
+	/**
+	 * Plays Block Breaker with the paddle following the ball for the given number of frames of 1/60 s, each advancing
+	 * the physics by four fixed steps, and renders every frame offscreen.
+	 */
+	bool RunBlockBreaker(const RunOptions& options, BoardSize size)
+	{
+		constexpr int steps_per_frame = 4;
+		constexpr double step_seconds = 1.0 / 240.0;
+
+		BlockBreaker::BlockBreakerConfig config = BlockBreakerConfigForBoard(size.width, size.height);
+		BlockBreaker::BlockBreakerSimulation simulation(config);
+		BlockBreaker::BoardCanvas board(config);
+		BlockBreaker::BlockBreakerSnapshot snapshot;
+		OffscreenRenderer renderer((size.width + 1) / 2, (size.height + 3) / 4);
+
+		std::uint64_t game = 1;
+		simulation.Reset();
+		for (int frame = 0; frame < options.frames; ++frame)
+		{
+			if (simulation.IsOver())
+			{
+				simulation.Reset();
+				++game;
+			}
+			FollowBall(simulation);
+			for (int step = 0; step < steps_per_frame && !simulation.IsOver(); ++step)
+			{
+				simulation.Step(step_seconds);
+			}
+
+			BlockBreaker::CaptureSnapshot(simulation, game, 0.0, snapshot);
+			renderer.Render(ftxui::canvas(&board.Update(snapshot)));
+		}
+
+		std::string name = "block_breaker_" + std::to_string(size.width) + "x" + std::to_string(size.height);
+		Report(name, renderer);
+		return CheckGolden(options, renderer, name);
+	}
+}
+
+/**
+ * Renders deterministic games of Snake and Block Breaker into an offscreen screen, without threads or a terminal.
+ * Reports the frames rendered per second and the bytes a diffing terminal writer would send per frame for each board
+ * size, and compares the last frame of each run with a golden frame if a golden directory is given.
+ * Usage: terminalMinigamesOffscreen [--game snake|block-breaker|all] [--sizes WxH,...] [--frames n]
+ *                                   [--golden-dir dir] [--update-golden]
+ */
+int main(int argc, char** argv)
+{
+	RunOptions options;
+
+	for (int index = 1; index < argc; ++index)
+	{
+		bool has_value = index + 1 < argc;
+		if (std::strcmp(argv[index], "--game") == 0 && has_value)
+		{
+			options.game = argv[++index];
+		}
+		else if (std::strcmp(argv[index], "--sizes") == 0 && has_value)
+		{
+			if (!ParseSizes(argv[++index], options.sizes))
+			{
+				std::cerr << "Invalid sizes: " << argv[index] << " (expected e.g. 200x100,400x200, at least 20x20)\n";
+				return EXIT_FAILURE;
+			}
+		}
+		else if (std::strcmp(argv[index], "--frames") == 0 && has_value)
+		{
+			options.frames = std::max(std::atoi(argv[++index]), 1);
+		}
+		else if (std::strcmp(argv[index], "--golden-dir") == 0 && has_value)
+		{
+			options.golden_dir = argv[++index];
+		}
+		else if (std::strcmp(argv[index], "--update-golden") == 0)
+		{
+			options.update_golden = true;
+		}
+		else
+		{
+			std::cerr << "Unknown argument: " << argv[index] << '\n';
+			return EXIT_FAILURE;
+		}
+	}
+
+	bool run_snake = options.game == "all" || options.game == "snake";
+	bool run_block_breaker = options.game == "all" || options.game == "block-breaker";
+	if (!run_snake && !run_block_breaker)
+	{
+		std::cerr << "Unknown game: " << options.game << '\n';
+		return EXIT_FAILURE;
+	}
+
+	bool passed = true;
+	if (run_snake)
+	{
+		Snake::SnakeConfig config;
+		for (BoardSize size : SizesFor(options, config.board_dimension_x, config.board_dimension_y))
+		{
+			passed &= RunSnake(options, size);
+		}
+	}
+	if (run_block_breaker)
+	{
+		BlockBreaker::BlockBreakerConfig config;
+		for (BoardSize size : SizesFor(options, config.board_dimension_x, config.board_dimension_y))
+		{
+			passed &= RunBlockBreaker(options, size);
+		}
+	}
+
+	return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
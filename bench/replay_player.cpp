@@ -0,0 +1,334 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ftxui/dom/canvas.hpp"
+#include "ftxui/dom/elements.hpp"
+
+#include "block_breaker.h"
+#include "offscreen_renderer.h"
+#include "replay.h"
+#include "snake_game.h"
+#include "util/random.h"
+
+using namespace TerminalMinigames;
+
+namespace
+{
+	using Clock = std::chrono::steady_clock;
+
+	struct PlayOptions
+	{
+		/**
+		 * Factor of the recorded game's speed to play at, zero to play as fast as possible.
+		 */
+		double speed = 1.0;
+		std::uint64_t from = 0;
+		std::uint64_t to = std::numeric_limits<std::uint64_t>::max();
+		bool board = false;
+		int seek_samples = 0;
+	};
+
+	/**
+	 * Rate at which the board is drawn during paced playback.
+	 */
+	constexpr double board_rate = 30.0;
+
+	std::string Describe(const Snake::SnakeSimulation& simulation)
+	{
+		const Snake::SnakeGameState& state = simulation.State();
+		std::vector<Snake::Cell> food(state.food_positions.begin(), state.food_positions.end());
+		std::sort(food.begin(), food.end());
+
+		std::ostringstream text;
+		text << "length " << state.snake_position_queue.Size() << ", head at cell " << state.snake_position_queue.Front()
+			<< ", moves " << state.moves << ", food at cells";
+		for (Snake::Cell cell : food)
+		{
+			text << ' ' << cell;
+		}
+		text << (state.won ? ", won" : state.isDead ? ", dead" : "");
+		return text.str();
+	}
+
+	std::string Describe(const BlockBreaker::BlockBreakerSimulation& simulation)
+	{
+		const BlockBreaker::BlockBreakerGameState& state = simulation.State();
+
+		std::ostringstream text;
+		text << std::setprecision(17) << "ball at (" << state.ball_position.x << ", " << state.ball_position.y << "), paddle at ("
+			<< state.paddle_position.x << ", " << state.paddle_position.y << ")"
+			<< ", " << state.destroyed_blocks.size() << " of " << state.blocks.Size() << " blocks destroyed"
+			<< (state.won ? ", won" : state.lost ? ", lost" : "");
+		return text.str();
+	}
+
+	/**
+	 * Game time the player's next tick takes when played at the recorded speed.
+	 */
+	double NextTickSeconds(const SnakeReplayPlayer& player)
+	{
+		return 1.0 / player.State().TickRate();
+	}
+
+	double NextTickSeconds(const BlockBreakerReplayPlayer& player)
+	{
+		return player.Recording().step_seconds;
+	}
+
+	/**
+	 * Draws the board of the player's current tick offscreen.
+	 */
+	class BoardView
+	{
+	public:
+		explicit BoardView(const SnakeReplayPlayer& player)
+			: width(player.State().Config().board_dimension_x), height(player.State().Config().board_dimension_y),
+			snake_board(std::make_unique<Snake::BoardCanvas>(player.State().Config()))
+		{
+		}
+
+		explicit BoardView(const BlockBreakerReplayPlayer& player)
+			: width(player.State().Config().board_dimension_x), height(player.State().Config().board_dimension_y),
+			block_breaker_board(std::make_unique<BlockBreaker::BoardCanvas>(player.State().Config()))
+		{
+		}
+
+		std::string Draw(const SnakeReplayPlayer& player)
+		{
+			Snake::CaptureSnapshot(player.State(), 1, snake_snapshot);
+			renderer.Render(ftxui::canvas(&snake_board->Update(snake_snapshot)));
+			return renderer.FrameText();
+		}
+
+		std::string Draw(const BlockBreakerReplayPlayer& player)
+		{
+			BlockBreaker::CaptureSnapshot(player.State(), 1, 0.0, block_breaker_snapshot);
+			renderer.Render(ftxui::canvas(&block_breaker_board->Update(block_breaker_snapshot)));
+			return renderer.FrameText();
+		}
+
+	private:
+		int width;
+		int height;
+		OffscreenRenderer renderer{ (width + 1) / 2, (height + 3) / 4 };
+
+		std::unique_ptr<Snake::BoardCanvas> snake_board;
+		Snake::SnakeSnapshot snake_snapshot;
+		std::unique_ptr<BlockBreaker::BoardCanvas> block_breaker_board;
+		BlockBreaker::BlockBreakerSnapshot block_breaker_snapshot;
+	};
+
+	/**
+	 * Seeks to random ticks in random order, so most seeks restore a keyframe, and compares each state reached with the
+	 * state a player simulating from the start without seeking reaches at the same tick.
+	 *
+	 * @returns Whether all states matched.
+	 */
+	template <typename Player>
+	bool CheckSeeking(Player& player, int samples)
+	{
+		Xoshiro256StarStar generator(1);
+		std::vector<std::uint64_t> targets;
+		for (int sample = 0; sample < samples; ++sample)
+		{
+			targets.push_back(UniformBelow(generator, player.Recording().end_tick + 1));
+		}
+
+		Player reference(player.Recording());
+		std::vector<std::string> expected;
+		std::vector<std::uint64_t> sorted_targets = targets;
+		std::sort(sorted_targets.begin(), sorted_targets.end());
+		for (std::uint64_t target : sorted_targets)
+		{
+			reference.SeekTo(target);
+			expected.push_back(Describe(reference.State()));
+		}
+
+		bool passed = true;
+		auto start = Clock::now();
+		for (std::uint64_t target : targets)
+		{
+			player.SeekTo(target);
+			size_t index = std::lower_bound(sorted_targets.begin(), sorted_targets.end(), target) - sorted_targets.begin();
+			if (Describe(player.State()) != expected[index])
+			{
+				std::cout << "Seeking to tick " << target << " reached a different state:\n"
+					<< "  expected: " << expected[index] << '\n'
+					<< "  actual:   " << Describe(player.State()) << '\n';
+				passed = false;
+			}
+		}
+		double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+		std::cout << "Seeked to " << samples << " random ticks, " << std::fixed << std::setprecision(1)
+			<< seconds * 1e6 / std::max(samples, 1) << " us per seek with " << player.Keyframes() << " keyframes"
+			<< (passed ? ", all states match\n" : "\n") << std::defaultfloat;
+		return passed;
+	}
+
+	/**
+	 * Plays the replay from the first to the last requested tick, paced to the recorded game's speed times the speed
+	 * factor or as fast as possible, and reports the state reached.
+	 */
+	template <typename Player>
+	bool Play(const Replay& replay, const PlayOptions& options)
+	{
+		Player player(replay);
+		BoardView view(player);
+		std::uint64_t last_tick = std::min(options.to, replay.end_tick);
+
+		auto seek_start = Clock::now();
+		player.SeekTo(options.from);
+		if (options.from > 0)
+		{
+			std::cout << "Seeked to tick " << player.Tick() << " in "
+				<< std::chrono::duration<double, std::milli>(Clock::now() - seek_start).count() << " ms\n";
+		}
+
+		bool paced = options.speed > 0.0;
+		auto start = Clock::now();
+		auto next_status = start;
+		double game_seconds = 0.0;
+		std::uint64_t first_tick = player.Tick();
+		if (paced && options.board)
+		{
+			std::cout << "\x1b[2J";
+		}
+		while (player.Tick() < last_tick)
+		{
+			game_seconds += NextTickSeconds(player);
+			player.Step();
+			if (!paced)
+			{
+				continue;
+			}
+
+			auto due = start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(game_seconds / options.speed));
+			std::this_thread::sleep_until(due);
+			if (due >= next_status)
+			{
+				next_status = due + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(options.board ? 1.0 / board_rate : 1.0));
+				if (options.board)
+				{
+					// Moves the cursor home, so every frame is drawn over the previous one
+					std::cout << "\x1b[H" << view.Draw(player) << std::flush;
+				}
+				else
+				{
+					std::cout << "tick " << player.Tick() << ": " << Describe(player.State()) << '\n';
+				}
+			}
+		}
+		double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+		if (options.board)
+		{
+			std::cout << (paced ? "\x1b[H" : "") << view.Draw(player) << '\n';
+		}
+		std::cout << "tick " << player.Tick() << ": " << Describe(player.State()) << '\n'
+			<< "Simulated " << player.Tick() - first_tick << " ticks (" << std::fixed << std::setprecision(1) << game_seconds
+			<< " s of game time) in " << std::setprecision(3) << seconds << " s, " << std::setprecision(0)
+			<< (player.Tick() - first_tick) / std::max(seconds, 1e-9) << " ticks/s\n" << std::defaultfloat;
+
+		return options.seek_samples == 0 || CheckSeeking(player, options.seek_samples);
+	}
+
+	const char* EndName(ReplayEnd end)
+	{
+		switch (end)
+		{
+		case ReplayEnd::GameOver: return "game over";
+		case ReplayEnd::Stopped: return "stopped";
+		default: return "truncated";
+		}
+	}
+}
+
+/**
+ * Plays back a recorded replay by simulating it again. Plays at the recorded speed times the given factor, or as fast
+ * as possible with --speed uncapped, optionally starting and stopping at given ticks and drawing the board.
+ * --seek-samples checks afterwards that seeking through the keyframes reaches the same states as simulating from the start.
+ * Usage: terminalMinigamesReplay file [--speed factor|uncapped] [--from tick] [--to tick] [--board] [--seek-samples n]
+ */
+int main(int argc, char** argv)
+{
+	PlayOptions options;
+	std::string path;
+
+	for (int index = 1; index < argc; ++index)
+	{
+		bool has_value = index + 1 < argc;
+		if (std::strcmp(argv[index], "--speed") == 0 && has_value)
+		{
+			++index;
+			options.speed = std::strcmp(argv[index], "uncapped") == 0 ? 0.0 : std::atof(argv[index]);
+			if (options.speed <= 0.0 && std::strcmp(argv[index], "uncapped") != 0)
+			{
+				std::cerr << "Invalid speed: " << argv[index] << " (expected a positive factor or uncapped)\n";
+				return EXIT_FAILURE;
+			}
+		}
+		else if (std::strcmp(argv[index], "--from") == 0 && has_value)
+		{
+			options.from = std::strtoull(argv[++index], nullptr, 10);
+		}
+		else if (std::strcmp(argv[index], "--to") == 0 && has_value)
+		{
+			options.to = std::strtoull(argv[++index], nullptr, 10);
+		}
+		else if (std::strcmp(argv[index], "--board") == 0)
+		{
+			options.board = true;
+		}
+		else if (std::strcmp(argv[index], "--seek-samples") == 0 && has_value)
+		{
+			options.seek_samples = std::max(std::atoi(argv[++index]), 0);
+		}
+		else if (path.empty() && argv[index][0] != '-')
+		{
+			path = argv[index];
+		}
+		else
+		{
+			std::cerr << "Unknown argument: " << argv[index] << '\n';
+			return EXIT_FAILURE;
+		}
+	}
+
+	if (path.empty())
+	{
+		std::cerr << "Usage: terminalMinigamesReplay file [--speed factor|uncapped] [--from tick] [--to tick] [--board] [--seek-samples n]\n";
+		return EXIT_FAILURE;
+	}
+
+	std::ifstream file(path, std::ios::binary);
+	Replay replay;
+	std::string error;
+	if (!file || !ReadReplay(file, replay, error))
+	{
+		std::cerr << "Could not read replay " << path << (error.empty() ? "" : ": " + error) << '\n';
+		return EXIT_FAILURE;
+	}
+
+	bool is_snake = replay.game == ReplayGame::Snake;
+	std::cout << (is_snake ? "Snake" : "Block Breaker") << " replay";
+	if (is_snake)
+	{
+		std::cout << " of seed " << replay.seed;
+	}
+	std::cout << ": " << replay.inputs.size() << " inputs over " << replay.end_tick << " ticks, " << EndName(replay.end) << '\n';
+
+	bool passed = is_snake ? Play<SnakeReplayPlayer>(replay, options) : Play<BlockBreakerReplayPlayer>(replay, options);
+	return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
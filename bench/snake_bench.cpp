@@ -0,0 +1,103 @@
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "allocation_counter.h"
+#include "autopilot.h"
+#include "snake_simulation.h"
+
+using namespace TerminalMinigames;
+using namespace TerminalMinigames::Snake;
+
+namespace
+{
+	/**
+	 * Board to benchmark the simulation on, in canvas pixels.
+	 */
+	struct BenchmarkBoard
+	{
+		std::string name;
+		int width;
+		int height;
+	};
+
+	/**
+	 * Result of running a board.
+	 */
+	struct BoardResult
+	{
+		double ticks_per_second;
+		/**
+		 * Heap allocations done while running the measured ticks.
+		 */
+		long allocations;
+	};
+
+	/**
+	 * Advances the simulation by one tick with the autopilot steering towards the food.
+	 * A new game with the next seed is started whenever the current one ends.
+	 */
+	void Tick(SnakeSimulation& simulation)
+	{
+		simulation.Step(Bench::NextSnakeTurn(simulation));
+
+		if (simulation.IsOver())
+		{
+			simulation.Reset(NextGameSeed(simulation.Seed()));
+		}
+	}
+
+	/**
+	 * Runs the given number of ticks on the given board after a warmup that lets all storage reach its steady-state size.
+	 */
+	BoardResult RunBoard(const BenchmarkBoard& board, long ticks)
+	{
+		SnakeSimulation simulation(Bench::SnakeConfigForBoard(board.width, board.height), 1);
+
+		for (long tick = 0; tick < ticks / 10; ++tick)
+		{
+			Tick(simulation);
+		}
+
+		long allocations_before = Bench::allocation_count.load();
+		auto start = std::chrono::steady_clock::now();
+		for (long tick = 0; tick < ticks; ++tick)
+		{
+			Tick(simulation);
+		}
+		std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+		return { ticks / elapsed.count(), Bench::allocation_count.load() - allocations_before };
+	}
+}
+
+/**
+ * Reports how many ticks per second the Snake simulation achieves on the default board and larger ones, with the
+ * autopilot playing and games restarted as they end.
+ * With --check-allocations the benchmark fails if any measured tick allocated heap memory.
+ * Usage: snakeBench [--check-allocations] [ticks per board]
+ */
+int main(int argc, char** argv)
+{
+	Bench::AllocationBenchmarkOptions options = Bench::ParseAllocationBenchmarkOptions(argc, argv, 1000000);
+
+	SnakeConfig config;
+	std::vector<BenchmarkBoard> boards = {
+		{ "default", config.board_dimension_x, config.board_dimension_y },
+		{ "large", 4 * config.board_dimension_x, 4 * config.board_dimension_y },
+		{ "huge", 16 * config.board_dimension_x, 16 * config.board_dimension_y }
+	};
+
+	bool allocated = false;
+	for (const auto& board : boards)
+	{
+		BoardResult result = RunBoard(board, options.ticks);
+		std::printf("%-8s %5dx%-5d %12.0f ticks/s  %ld allocations\n",
+			board.name.c_str(), board.width, board.height, result.ticks_per_second, result.allocations);
+
+		allocated = allocated || result.allocations != 0;
+	}
+
+	return Bench::AllocationCheckResult(options, allocated);
+}
@@ -0,0 +1,362 @@
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "ftxui/dom/canvas.hpp"
+#include "ftxui/dom/elements.hpp"
+
+#include "autopilot.h"
+#include "bench_harness.h"
+#include "block_breaker.h"
+#include "block_breaker_simulation.h"
+#include "offscreen_renderer.h"
+#include "snake_game.h"
+#include "snake_simulation.h"
+#include "util/box_overlap.h"
+#include "util/geometry.h"
+#include "util/random.h"
+#include "util/vector2d.h"
+
+using namespace TerminalMinigames;
+using namespace TerminalMinigames::Bench;
+
+namespace
+{
+	/**
+	 * Number of precomputed inputs the micro benchmarks cycle through, so the branch predictor cannot learn the results.
+	 */
+	constexpr size_t input_count = 1024;
+
+	std::vector<Vector2D::Vector2D> RandomPoints(Xoshiro256StarStar& generator, double max_x, double max_y)
+	{
+		std::uniform_real_distribution<double> x_distribution(0.0, max_x);
+		std::uniform_real_distribution<double> y_distribution(0.0, max_y);
+
+		std::vector<Vector2D::Vector2D> points;
+		for (size_t index = 0; index < input_count; ++index)
+		{
+			points.emplace_back(x_distribution(generator), y_distribution(generator));
+		}
+		return points;
+	}
+
+	/**
+	 * Draws the board of the given snapshot into a fresh canvas and renders it into a screen, like the first frame of a game.
+	 */
+	template <typename Board, typename Config, typename Snapshot>
+	void RenderFreshBoard(const Config& config, const Snapshot& snapshot)
+	{
+		Board board(config);
+		OffscreenRenderer renderer((config.board_dimension_x + 1) / 2, (config.board_dimension_y + 3) / 4);
+		renderer.Render(ftxui::canvas(&board.Update(snapshot)));
+		DoNotOptimize(renderer.FrameText());
+	}
+
+	void AddGeometryBenchmarks(BenchmarkSuite& suite)
+	{
+		Xoshiro256StarStar generator(1);
+		auto points = std::make_shared<std::vector<Vector2D::Vector2D>>(RandomPoints(generator, 200.0, 100.0));
+
+		suite.Add("geometry/LineSegmentsIntersect", [points](long iterations)
+			{
+				const auto& p = *points;
+				for (long iteration = 0; iteration < iterations; ++iteration)
+				{
+					size_t index = static_cast<size_t>(iteration) & (input_count - 1);
+					DoNotOptimize(LineSegmentsIntersect(p[index], p[(index + 1) & (input_count - 1)],
+						p[(index + 2) & (input_count - 1)], p[(index + 3) & (input_count - 1)]));
+				}
+			});
+
+		suite.Add("vector2d/Arithmetic", [points](long iterations)
+			{
+				const auto& p = *points;
+				Vector2D::Vector2D accumulator(0.0, 0.0);
+				for (long iteration = 0; iteration < iterations; ++iteration)
+				{
+					const auto& point = p[static_cast<size_t>(iteration) & (input_count - 1)];
+					accumulator = (accumulator + point * 0.5 - point / 4.0) * 0.99;
+					DoNotOptimize(accumulator);
+				}
+			});
+
+		suite.Add("vector2d/Hash", [points](long iterations)
+			{
+				const auto& p = *points;
+				boost::hash<Vector2D::Vector2D> hasher;
+				for (long iteration = 0; iteration < iterations; ++iteration)
+				{
+					DoNotOptimize(hasher(p[static_cast<size_t>(iteration) & (input_count - 1)]));
+				}
+			});
+	}
+
+	void AddRandomBenchmarks(BenchmarkSuite& suite)
+	{
+		// Bounds of the size of the free cell index while the snake grows, as when spawning food
+		auto bounds = std::make_shared<std::vector<std::uint64_t>>();
+		Xoshiro256StarStar bound_generator(3);
+		for (size_t index = 0; index < input_count; ++index)
+		{
+			bounds->push_back(1 + UniformBelow(bound_generator, static_cast<std::uint64_t>(Snake::SnakeConfig{}.CellCount())));
+		}
+
+		auto generator = std::make_shared<Xoshiro256StarStar>(4);
+		suite.Add("random/Xoshiro256StarStar", [generator](long iterations)
+			{
+				for (long iteration = 0; iteration < iterations; ++iteration)
+				{
+					DoNotOptimize((*generator)());
+				}
+			});
+
+		auto bounded_generator = std::make_shared<Xoshiro256StarStar>(6);
+		suite.Add("random/UniformBelow", [bounded_generator, bounds](long iterations)
+			{
+				for (long iteration = 0; iteration < iterations; ++iteration)
+				{
+					DoNotOptimize(UniformBelow(*bounded_generator, (*bounds)[static_cast<size_t>(iteration) & (input_count - 1)]));
+				}
+			});
+
+		// The standard generator and distribution the snake's food placement used before, for comparison
+		auto mt19937 = std::make_shared<std::mt19937>(5);
+		suite.Add("random/mt19937+uniform_int_distribution", [mt19937, bounds](long iterations)
+			{
+				for (long iteration = 0; iteration < iterations; ++iteration)
+				{
+					std::uniform_int_distribution<std::uint64_t> distribution(0, (*bounds)[static_cast<size_t>(iteration) & (input_count - 1)] - 1);
+					DoNotOptimize(distribution(*mt19937));
+				}
+			});
+	}
+
+	void AddOverlapBenchmarks(BenchmarkSuite& suite)
+	{
+		// Boxes of the largest stress level of blockBreakerBench, filtered by the swept bounds of one ball step
+		struct OverlapInput
+		{
+			std::vector<double> left, top, right, bottom;
+			std::vector<std::uint32_t> indices;
+			std::vector<std::uint32_t> overlapping;
+			std::vector<Vector2D::Vector2D> queries;
+		};
+		auto input = std::make_shared<OverlapInput>();
+		Xoshiro256StarStar generator(2);
+		for (const auto& block : BlockBreaker::CreateLevel(100, 200))
+		{
+			input->indices.push_back(static_cast<std::uint32_t>(input->left.size()));
+			input->left.push_back(block.end_left.x);
+			input->top.push_back(block.end_left.y);
+			input->right.push_back(block.end_right.x);
+			input->bottom.push_back(block.end_right.y);
+		}
+		input->overlapping.resize(input->indices.size());
+		input->queries = RandomPoints(generator, 1600.0, 600.0);
+
+		for (auto kernel : { OverlapKernel::Scalar, OverlapKernel::Sse2, OverlapKernel::Avx2 })
+		{
+			if (!IsOverlapKernelSupported(kernel))
+			{
+				continue;
+			}
+
+			suite.Add("box_overlap/FilterOverlappingBoxes/" + ToString(kernel), [input, kernel](long iterations)
+				{
+					BoxArrays boxes = { input->left.data(), input->top.data(), input->right.data(), input->bottom.data() };
+					for (long iteration = 0; iteration < iterations; ++iteration)
+					{
+						const auto& query = input->queries[static_cast<size_t>(iteration) & (input_count - 1)];
+						DoNotOptimize(FilterOverlappingBoxes(kernel, boxes, input->indices,
+							query.x, query.y, query.x + 4.0, query.y + 4.0, input->overlapping.data()));
+					}
+				});
+		}
+	}
+
+	void AddSimulationBenchmarks(BenchmarkSuite& suite)
+	{
+		auto snake = std::make_shared<Snake::SnakeSimulation>(Snake::SnakeConfig{}, 1);
+		suite.Add("snake/Step", [snake](long iterations)
+			{
+				for (long iteration = 0; iteration < iterations; ++iteration)
+				{
+					if (snake->IsOver())
+					{
+						snake->Reset(NextGameSeed(snake->Seed()));
+					}
+					DoNotOptimize(snake->Step(NextSnakeTurn(*snake)));
+				}
+			});
+
+		// Resetting lays out the snake and spawns the first food, which samples the free cell index
+		auto spawning_snake = std::make_shared<Snake::SnakeSimulation>(Snake::SnakeConfig{}, 1);
+		suite.Add("snake/ResetAndSpawnFood", [spawning_snake](long iterations)
+			{
+				for (long iteration = 0; iteration < iterations; ++iteration)
+				{
+					spawning_snake->Reset(static_cast<std::uint64_t>(iteration));
+					DoNotOptimize(spawning_snake->State().food_positions.size());
+				}
+			});
+
+		auto blocks = std::make_shared<std::vector<BlockBreaker::Block>>(BlockBreaker::CreateLevel());
+		auto block_breaker = std::make_shared<BlockBreaker::BlockBreakerSimulation>();
+		block_breaker->Reset(*blocks);
+		suite.Add("block_breaker/Step", [block_breaker, blocks](long iterations)
+			{
+				for (long iteration = 0; iteration < iterations; ++iteration)
+				{
+					FollowBall(*block_breaker);
+					block_breaker->Step(1.0 / 240.0);
+					if (block_breaker->IsOver())
+					{
+						block_breaker->Reset(*blocks);
+					}
+				}
+				DoNotOptimize(block_breaker->State().ball_position);
+			});
+	}
+
+	void AddRenderBenchmarks(BenchmarkSuite& suite)
+	{
+		// Canvas pixels are set by drawing single cells, the smallest drawing operation of the games
+		auto config = std::make_shared<Snake::SnakeConfig>();
+		auto cell_canvas = std::make_shared<ftxui::Canvas>(config->board_dimension_x, config->board_dimension_y);
+		suite.Add("canvas/DrawAndEraseCell", [config, cell_canvas](long iterations)
+			{
+				for (long iteration = 0; iteration < iterations; ++iteration)
+				{
+					auto cell = static_cast<Snake::Cell>(iteration % config->CellCount());
+					Snake::DrawCell(cell_canvas.get(), *config, cell, ftxui::Color::Green);
+					Snake::EraseCell(cell_canvas.get(), *config, cell);
+				}
+			});
+
+		// A snake of a few dozen cells, as in the middle of a game
+		auto snake = std::make_shared<Snake::SnakeSimulation>(Snake::SnakeConfig{}, 1);
+		for (int step = 0; step < 2000 && snake->State().snake_position_queue.Size() < 40; ++step)
+		{
+			if (snake->IsOver())
+			{
+				snake->Reset(NextGameSeed(snake->Seed()));
+			}
+			snake->Step(NextSnakeTurn(*snake));
+		}
+		auto snake_snapshot = std::make_shared<Snake::SnakeSnapshot>();
+		Snake::CaptureSnapshot(*snake, 1, *snake_snapshot);
+		suite.Add("render/SnakeBoard", [snake, snake_snapshot](long iterations)
+			{
+				for (long iteration = 0; iteration < iterations; ++iteration)
+				{
+					RenderFreshBoard<Snake::BoardCanvas>(snake->Config(), *snake_snapshot);
+				}
+			});
+
+		auto block_breaker = std::make_shared<BlockBreaker::BlockBreakerSimulation>();
+		block_breaker->Reset();
+		auto block_breaker_snapshot = std::make_shared<BlockBreaker::BlockBreakerSnapshot>();
+		BlockBreaker::CaptureSnapshot(*block_breaker, 1, 0.0, *block_breaker_snapshot);
+		suite.Add("render/BlockBreakerBoard", [block_breaker, block_breaker_snapshot](long iterations)
+			{
+				for (long iteration = 0; iteration < iterations; ++iteration)
+				{
+					RenderFreshBoard<BlockBreaker::BoardCanvas>(block_breaker->Config(), *block_breaker_snapshot);
+				}
+			});
+	}
+}
+
+/**
+ * Micro and macro benchmarks of the geometry, collision, simulation and rendering code.
+ * Every benchmark is calibrated to a minimum repetition length, warmed up and repeated, and reported as the statistics of
+ * its repetitions in nanoseconds per iteration. Results can be written as JSON and a previously written file can be
+ * passed as baseline, in which case the benchmark fails if any median got slower than the threshold allows.
+ * Usage: terminalMinigamesBench [--filter text] [--repetitions n] [--warmup-ms ms] [--min-time-ms ms]
+ *                               [--json file] [--baseline file] [--threshold percent]
+ */
+int main(int argc, char** argv)
+{
+	BenchmarkOptions options;
+	std::string json_path;
+	std::string baseline_path;
+	double threshold_percent = 10.0;
+
+	for (int index = 1; index < argc; ++index)
+	{
+		bool has_value = index + 1 < argc;
+		if (std::strcmp(argv[index], "--filter") == 0 && has_value)
+		{
+			options.filter = argv[++index];
+		}
+		else if (std::strcmp(argv[index], "--repetitions") == 0 && has_value)
+		{
+			options.repetitions = std::atoi(argv[++index]);
+		}
+		else if (std::strcmp(argv[index], "--warmup-ms") == 0 && has_value)
+		{
+			options.warmup_ms = std::atof(argv[++index]);
+		}
+		else if (std::strcmp(argv[index], "--min-time-ms") == 0 && has_value)
+		{
+			options.min_repetition_ms = std::atof(argv[++index]);
+		}
+		else if (std::strcmp(argv[index], "--json") == 0 && has_value)
+		{
+			json_path = argv[++index];
+		}
+		else if (std::strcmp(argv[index], "--baseline") == 0 && has_value)
+		{
+			baseline_path = argv[++index];
+		}
+		else if (std::strcmp(argv[index], "--threshold") == 0 && has_value)
+		{
+			threshold_percent = std::atof(argv[++index]);
+		}
+		else
+		{
+			std::cerr << "Unknown argument: " << argv[index] << '\n';
+			return EXIT_FAILURE;
+		}
+	}
+
+	BenchmarkSuite suite;
+	AddGeometryBenchmarks(suite);
+	AddRandomBenchmarks(suite);
+	AddOverlapBenchmarks(suite);
+	AddSimulationBenchmarks(suite);
+	AddRenderBenchmarks(suite);
+
+	auto results = suite.Run(options, std::cout);
+
+	if (!json_path.empty())
+	{
+		std::ofstream json(json_path);
+		WriteJson(json, results);
+	}
+
+	if (!baseline_path.empty())
+	{
+		std::ifstream baseline_file(baseline_path);
+		if (!baseline_file)
+		{
+			std::cerr << "Could not read the baseline " << baseline_path << '\n';
+			return EXIT_FAILURE;
+		}
+
+		std::cout << "\nCompared with " << baseline_path << ":\n";
+		int regressions = CompareWithBaseline(std::cout, results, ReadBaseline(baseline_file), threshold_percent);
+		if (regressions > 0)
+		{
+			std::cout << "FAILED: " << regressions << " benchmark(s) slower than the baseline by more than " << threshold_percent << "%\n";
+			return EXIT_FAILURE;
+		}
+	}
+
+	return EXIT_SUCCESS;
+}
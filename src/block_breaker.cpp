@@ -1,475 +1,469 @@
-#include "block_breaker.h"
-#include "block_breaker.h"
-#include <thread>
 #include <format>
-#include <mutex>
-#include <unordered_set>
+#include <limits>
 
 #include "ftxui/component/screen_interactive.hpp" // for ScreenInteractive
 #include "ftxui/component/component.hpp"          // for Menu
 #include "ftxui/dom/elements.hpp"                 // for vbox, xflex, size
 #include "ftxui/component/event.hpp"
 
-#include "boost/chrono/chrono.hpp"
-#include "boost/chrono/time_point.hpp"
-
 #include "block_breaker.h"
+#include "util/fixed_timestep.h"
+#include "util/latency_stats.h"
+#include "util/profiler.h"
 #include "util/util.h"
 
 namespace TerminalMinigames
 {
 	namespace BlockBreaker
 	{
-		/** Definitions of member functions. **/
-		
-		void Block::Draw(ftxui::Canvas& canvas)
+		void DrawBlock(ftxui::Canvas& canvas, const Block& block)
+		{
+			canvas.DrawBlockLine(block.end_left.x, block.end_left.y, block.end_right.x, block.end_left.y);
+			canvas.DrawBlockLine(block.end_left.x, block.end_right.y, block.end_right.x, block.end_right.y);
+		}
+
+		void EraseBlock(ftxui::Canvas& canvas, const Block& block)
 		{
-			canvas.DrawBlockLine(end_left.x, end_left.y, end_right.x, end_left.y);
-			canvas.DrawBlockLine(end_left.x, end_right.y, end_right.x, end_right.y);
+			for (int x = static_cast<int>(block.end_left.x); x <= static_cast<int>(block.end_right.x); ++x)
+			{
+				canvas.DrawBlockOff(x, static_cast<int>(block.end_left.y));
+				canvas.DrawBlockOff(x, static_cast<int>(block.end_right.y));
+			}
 		}
 
+		/** Variables needed for execution. **/
 		/**
-		 * Struct containing all necessary settings/configurations for the block breaker game.
+		 * Rate at which the physics are stepped.
 		 */
-		struct BlockBreakerConfig
-		{
-			int board_dimension_x = 102;
-			int board_dimension_y = 100;
+		constexpr double physics_rate = 240.0;
 
-			int paddle_width = 14;
-			int paddle_height = 1;
-			int paddle_step_size = 2;
-			Vector2D::Vector2D paddle_start_position = { 47, 88 };
+		/**
+		 * Rate at which the update task resumes to advance the physics and update the snapshot, each time causing a new frame.
+		 */
+		constexpr double render_rate = 30.0;
 
-			float ball_speed_initial = 10.f;
-			float ball_radius = 0.5f;
+		/** **/
 
-			/**
-			 * Factor by which the ball speed is multiplied by for each paddle contact.
-			 */
-			float speed_increase_factor = 1.01f;
+		void CaptureSnapshot(const BlockBreakerSimulation& simulation, std::uint64_t game, double alpha, BlockBreakerSnapshot& snapshot)
+		{
+			const BlockBreakerGameState& game_state = simulation.State();
 
-			/**
-			 * Minimum angle theta that the ball will be returned at from the paddle.
-			 */
-			float min_theta = 20.f;
-		} block_breaker_config;
+			snapshot.paddle_position = game_state.paddle_position;
+			snapshot.ball_position = simulation.InterpolatedBallPosition(alpha);
+			snapshot.ball_direction = game_state.ball_direction;
 
-		void BlockBreakerGameState::Reset()
-		{
-			// Init rows of blocks to destroy:
-			for (double y = 6.f; y < 19.f; y += 6.f)
+			// The level only has to be copied once per game and snapshot. The snapshot still holds the blocks destroyed
+			// up to an earlier frame, so only the ones destroyed since are added.
+			if (snapshot.game != game)
 			{
-				for (double x = 4.f; x < 97.f; x += 8.f)
+				snapshot.game = game;
+				snapshot.level_blocks.clear();
+				for (std::uint32_t index = 0; index < game_state.blocks.Size(); ++index)
 				{
-					Block b = { { x, y }, { x + 5.f, y + 2.f } };
-					block_positions.insert(b);
+					snapshot.level_blocks.push_back(game_state.blocks.Get(index));
 				}
+				snapshot.destroyed_blocks.clear();
 			}
+			snapshot.destroyed_blocks.insert(snapshot.destroyed_blocks.end(),
+				game_state.destroyed_blocks.begin() + snapshot.destroyed_blocks.size(), game_state.destroyed_blocks.end());
 
-			paddle_position = block_breaker_config.paddle_start_position;
-			ball_position = { paddle_position.x, paddle_position.y - block_breaker_config.paddle_height - 2 };
-			ball_direction = { 0, -block_breaker_config.ball_speed_initial };
-			ball_speed = block_breaker_config.ball_speed_initial;
-
-			lost = false;
+			snapshot.lost = game_state.lost;
+			snapshot.won = game_state.won;
 		}
 
-		/** **/
-
-		/** Variables needed for execution. **/
-		BlockBreakerGameState game_state;
-		std::mutex paddle_mutex;
-		std::mutex ball_mutex;
-		std::mutex block_positions_mutex;
-
-		CollisionTypes last_collision = CollisionTypes::None;
-
-		bool restart_flag;
-
-		/** **/
+		/**
+		 * Brings the session's snapshot up to date with its simulation's current state.
+		 * 
+		 * @param alpha Fraction of a physics step passed since the last step, to interpolate the ball position with.
+		 */
+		void UpdateSnapshot(BlockBreakerSession& session, double alpha)
+		{
+			CaptureSnapshot(session.simulation, session.game_count, alpha, session.snapshot);
+			session.snapshot.input_latency = session.input_latency;
+		}
 
-		void UpdateBall(ftxui::ScreenInteractive& screen, BlockBreakerGameState& state, bool* back_flag)
+		Task UpdateBall(CoroutineScheduler& scheduler, BlockBreakerSession& session)
 		{
-			auto start = boost::chrono::high_resolution_clock::now();
-			double delta_time = 0;
+			BlockBreakerSimulation& simulation = session.simulation;
+			using namespace std::chrono_literals;
+			auto frame_duration = std::chrono::duration_cast<std::chrono::steady_clock::duration>(1.0s / render_rate);
 
-			while (!(*back_flag) && !state.lost && !state.won)
-			{
-				using namespace std::chrono_literals;
-				std::this_thread::sleep_for(1.0s / 30.f);
+			FixedTimestep physics_clock(physics_rate);
 
-				// Compute delta time
-				delta_time = boost::chrono::duration_cast<boost::chrono::milliseconds>(boost::chrono::high_resolution_clock::now() - start).count() / 1000.f;
-				start = boost::chrono::high_resolution_clock::now();
+			simulation.Reset();
+			++session.game_count;
+			UpdateSnapshot(session, 0.0);
 
-				ball_mutex.lock();
+			auto last_update = std::chrono::steady_clock::now();
+			auto next_frame = last_update + frame_duration;
 
-				// Move ball
-				state.ball_position_prev = state.ball_position;
-				auto state_cache = state;
-				auto position_change = state.ball_direction * delta_time;
-				state.ball_position += state.ball_direction * delta_time;
-				state_cache = state;
+			bool is_over = false;
+			while (!is_over)
+			{
+				co_await scheduler.SleepUntil(next_frame);
+				next_frame += frame_duration;
 
-				// Check & handle border collision
-				auto collision_type = IntersectsBorder(state.ball_position, block_breaker_config.ball_radius);
-				HandleCollision(state, collision_type, true);
+				// Catch up on the real time passed in fixed steps, however late the task was resumed
+				auto now = std::chrono::steady_clock::now();
+				int steps = physics_clock.Advance(now - last_update);
+				last_update = now;
 
-				// Check & handle paddle collision
-				if (IntersectsPaddle(state, block_breaker_config.ball_radius))
+				for (int step = 0; step < steps && !simulation.IsOver(); ++step)
 				{
-					HandlePaddleCollision(state);
+					ProfileScope profile(ProfilePhase::SimulationStep);
+					simulation.Step(physics_clock.StepSeconds());
+					session.recording.Tick();
 				}
+				UpdateSnapshot(session, physics_clock.Alpha());
+				is_over = simulation.IsOver();
+			}
+			session.recording.GameOver();
+		}
 
-				// Check & handle block collision
-				CheckAndHandleBlockCollision(state, block_breaker_config.ball_radius);
+		Task HandlePaddleInput(BlockBreakerSession& session)
+		{
+			BlockBreakerSimulation& simulation = session.simulation;
+			session.inputs.Clear();
 
-				ball_mutex.unlock();
+			while (!simulation.IsOver())
+			{
+				InputEvent event = co_await session.inputs.Receive();
+				if (simulation.IsOver())
+				{
+					break;
+				}
 
-				screen.PostEvent(ftxui::Event::Custom);
+				simulation.MovePaddle(event.direction);
+				session.recording.Input(event.direction);
+				session.input_latency.Record(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - event.timestamp).count());
 			}
 		}
 
-		void UpdateScreen(ftxui::ScreenInteractive& screen, ftxui::Component& comp)
+		const ftxui::Canvas& BoardCanvas::Update(const BlockBreakerSnapshot& snapshot)
 		{
-			screen.Loop(comp);
+			bool is_over = snapshot.lost || snapshot.won;
+			if (snapshot.game != drawn_game || is_over != drawn_over)
+			{
+				Rebuild(snapshot);
+			}
+			else if (!is_over)
+			{
+				ApplyChanges(snapshot);
+			}
+			return canvas;
 		}
 
-		void ExecuteBlockBreaker(QuitFunction quit_function, bool* back_to_menu)
+		void BoardCanvas::Rebuild(const BlockBreakerSnapshot& snapshot)
 		{
-			game_state.Reset();
+			canvas = ftxui::Canvas(config.board_dimension_x, config.board_dimension_y);
 
-			ftxui::Component event_catcher;
+			drawn_game = snapshot.game;
+			drawn_over = snapshot.lost || snapshot.won;
+			drawn_paddle = snapshot.paddle_position;
+			drawn_ball = snapshot.ball_position;
 
-			auto screen = ftxui::ScreenInteractive::Fullscreen();
-			auto container = ftxui::Container::Vertical({});
+			alive.assign(snapshot.level_blocks.size(), true);
+			for (std::uint32_t index : snapshot.destroyed_blocks)
+			{
+				alive[index] = false;
+			}
+			drawn_destroyed = snapshot.destroyed_blocks.size();
 
-			auto game_view_renderer = ftxui::Renderer([&]
+			// Index the blocks by the text cells they are drawn in, to redraw the ones sharing a cell with something erased
+			columns = (canvas.width() + 1) / 2;
+			blocks_by_cell.assign(static_cast<size_t>(columns) * ((canvas.height() + 3) / 4), {});
+			for (std::uint32_t index = 0; index < snapshot.level_blocks.size(); ++index)
+			{
+				const Block& block = snapshot.level_blocks[index];
+				for (int y : { static_cast<int>(block.end_left.y), static_cast<int>(block.end_right.y) })
 				{
-					auto canvas = ftxui::Canvas(block_breaker_config.board_dimension_x, block_breaker_config.board_dimension_y);
-
-					// Draw custom border around canvas:
-					canvas.DrawBlockLine(0, 2, canvas.width(), 2); // top border
-					canvas.DrawBlockLine(0, 2, 0, canvas.height() - 3); // left border (part 1)
-					canvas.DrawBlockLine(1, 2, 1, canvas.height() - 3); // left border (part 2)
-					canvas.DrawBlockLine(canvas.width() - 1, 2, canvas.width() - 1, canvas.height() - 3); // right border (part 1)
-					canvas.DrawBlockLine(canvas.width() - 2, 2, canvas.width() - 2, canvas.height() - 3); // right border (part 1)
-					canvas.DrawBlockLine(0, canvas.height() - 3, canvas.width() - 1, canvas.height() - 3); // bottom border
-
-					paddle_mutex.lock();
-					// Draw paddle:
-					canvas.DrawBlockLine(
-						game_state.paddle_position.x - block_breaker_config.paddle_width / 2,
-						game_state.paddle_position.y,
-						game_state.paddle_position.x + block_breaker_config.paddle_width / 2 - 1,
-						game_state.paddle_position.y);
-					paddle_mutex.unlock();
-
-					if (game_state.lost)
-					{
-						PrintGameOverToCanvas(canvas, Vector2D::Vector2D(12, 20), true);
-					}
-					else if (game_state.won)
-					{
-						PrintWonMessageToCanvas(canvas, Vector2D::Vector2D(6, 20));
-					}
-					else
+					for (int x = static_cast<int>(block.end_left.x); x <= static_cast<int>(block.end_right.x); ++x)
 					{
-						// Draw ball:
-						ball_mutex.lock();
-						canvas.DrawPoint(game_state.ball_position.x, game_state.ball_position.y, true);
-						ball_mutex.unlock();
-
-						// Draw blocks:
-						block_positions_mutex.lock();
-						for (auto b : game_state.block_positions)
+						if (auto* blocks = BlocksInCell(x, y); blocks && (blocks->empty() || blocks->back() != index))
 						{
-							b.Draw(canvas);
+							blocks->push_back(index);
 						}
-						block_positions_mutex.unlock();
 					}
+				}
+			}
 
-					return ftxui::canvas(std::move(canvas));
-				});
-
-			container->Add(game_view_renderer);
-
-			// Quit button
-			std::string quit_button_label = "Back to Menu";
-			auto quit_button = ftxui::Button(&quit_button_label, [&] { quit_function(); });
-			container->Add(quit_button);
-
-			// Restart button
-			std::string restart_button_label = "Restart";
-			auto restart_button = ftxui::Button(&restart_button_label, [&] { game_state.Reset(); restart_flag = true; });
-			container->Add(restart_button);
-
-			auto screen_view_renderer = ftxui::Renderer(container, [&] {
-				auto ball_position_text = std::format("Ball Position: {}", game_state.ball_position.ToString());
-				auto speed_text = std::format("Speed: {}", Vector2D::Magnitude(game_state.ball_direction));
-
-				return ftxui::vbox({
-					ftxui::text("Terminal Minigames") | ftxui::bold | ftxui::center,
-					ftxui::text(""),
-					ftxui::hbox({
-						game_view_renderer->Render(),
-						ftxui::vbox({
-							quit_button->Render(),
-							restart_button->Render(),
-							ftxui::filler()
-						})
-					}),
-					ftxui::text(ball_position_text),
-					ftxui::text(speed_text)
-					});
-			});
+			// Draw custom border around canvas:
+			canvas.DrawBlockLine(0, 2, canvas.width(), 2); // top border
+			canvas.DrawBlockLine(0, 2, 0, canvas.height() - 3); // left border (part 1)
+			canvas.DrawBlockLine(1, 2, 1, canvas.height() - 3); // left border (part 2)
+			canvas.DrawBlockLine(canvas.width() - 1, 2, canvas.width() - 1, canvas.height() - 3); // right border (part 1)
+			canvas.DrawBlockLine(canvas.width() - 2, 2, canvas.width() - 2, canvas.height() - 3); // right border (part 1)
+			canvas.DrawBlockLine(0, canvas.height() - 3, canvas.width() - 1, canvas.height() - 3); // bottom border
+
+			DrawPaddle();
 
-			auto screen_view_event_catch_wrapper = ftxui::CatchEvent(screen_view_renderer, [&](ftxui::Event e) 
-				{ 
-					if (e == ftxui::Event::ArrowLeft)
+			if (snapshot.lost)
+			{
+				PrintGameOverToCanvas(canvas, Vector2D::Vector2D(12, 20), true);
+			}
+			else if (snapshot.won)
+			{
+				PrintWonMessageToCanvas(canvas, Vector2D::Vector2D(6, 20));
+			}
+			else
+			{
+				// Draw blocks:
+				for (std::uint32_t index = 0; index < snapshot.level_blocks.size(); ++index)
+				{
+					if (alive[index])
 					{
+						DrawBlock(canvas, snapshot.level_blocks[index]);
+					}
+				}
 
-						game_state.last_input = InputDirection::Left;
-						if (game_state.paddle_position.x - block_breaker_config.paddle_step_size >= 1 + block_breaker_config.paddle_width / 2)
-						{
-							game_state.paddle_position.x -= block_breaker_config.paddle_step_size;
-						}
+				// Draw ball:
+				canvas.DrawPoint(drawn_ball.x, drawn_ball.y, true);
+			}
+		}
 
-						return true;
-					}
-					else if (e == ftxui::Event::ArrowRight)
-					{
-						game_state.last_input = InputDirection::Right;
-						if (game_state.paddle_position.x + block_breaker_config.paddle_step_size <= block_breaker_config.board_dimension_x - 2 - block_breaker_config.paddle_width / 2)
-						{
-							game_state.paddle_position.x += block_breaker_config.paddle_step_size;
-						}
+		void BoardCanvas::ApplyChanges(const BlockBreakerSnapshot& snapshot)
+		{
+			// The ball's braille cell replaces whatever else was drawn in its text cell, so that has to be drawn again
+			canvas.DrawPointOff(drawn_ball.x, drawn_ball.y);
+			RestoreCell(drawn_ball.x, drawn_ball.y, snapshot);
 
-						return true;
-					}
-					else if (e == ftxui::Event::ArrowDown || e == ftxui::Event::ArrowUp)
-					{
-						// Catch input but no actions to be done
-						return true;
-					}
-					return false;  
-				});
+			for (; drawn_destroyed < snapshot.destroyed_blocks.size(); ++drawn_destroyed)
+			{
+				std::uint32_t index = snapshot.destroyed_blocks[drawn_destroyed];
+				const Block& block = snapshot.level_blocks[index];
+				alive[index] = false;
 
-			// Create update thread
-			std::thread update_screen(UpdateScreen, std::ref(screen), std::ref(screen_view_event_catch_wrapper));
+				EraseBlock(canvas, block);
+				for (int x = static_cast<int>(block.end_left.x); x <= static_cast<int>(block.end_right.x); x += 2)
+				{
+					RestoreCell(x, block.end_left.y, snapshot);
+					RestoreCell(x, block.end_right.y, snapshot);
+				}
+				RestoreCell(block.end_right.x, block.end_left.y, snapshot);
+				RestoreCell(block.end_right.x, block.end_right.y, snapshot);
+			}
 
-			std::thread update_ball;
-			restart_flag = true;
-			while (!(*back_to_menu))
+			if (snapshot.paddle_position != drawn_paddle)
 			{
-				if (restart_flag) // check if should restart the update ball thread
+				auto [left, right, y] = PaddlePixels();
+				drawn_paddle = snapshot.paddle_position;
+				for (int x = left; x <= right; ++x)
 				{
-					update_ball = std::thread(UpdateBall, std::ref(screen), std::ref(game_state), back_to_menu);
-					restart_flag = false;
-					screen.PostEvent(ftxui::Event::Custom);
+					canvas.DrawBlockOff(x, y);
 				}
-				if (update_ball.joinable())
+				for (int x = left; x <= right + 1; x += 2)
 				{
-					update_ball.join();
+					RestoreCell(x, y, snapshot);
 				}
+				DrawPaddle();
 			}
 
-			update_screen.join();
+			drawn_ball = snapshot.ball_position;
+			canvas.DrawPoint(drawn_ball.x, drawn_ball.y, true);
 		}
 
-		CollisionTypes BlockBreaker::IntersectsBorder(Vector2D::Vector2D& pos, float ball_radius)
+		BoardCanvas::PaddleLine BoardCanvas::PaddlePixels() const
 		{
-			if (pos.x - ball_radius < 2 && pos.y - ball_radius < block_breaker_config.board_dimension_y - 3 && pos.y + ball_radius >= 1)
-			{
-				return CollisionTypes::Left;
-			}
-			else if (pos.x - ball_radius < 2 && pos.y - ball_radius < 1)
-			{
-				return CollisionTypes::TopLeft;
-			}
-			else if (pos.x - ball_radius < 2 && pos.y + ball_radius > block_breaker_config.board_dimension_y - 3)
-			{
-				return CollisionTypes::BottomLeft;
-			}
-			else if (pos.x + ball_radius > block_breaker_config.board_dimension_x - 3 && pos.y - ball_radius < block_breaker_config.board_dimension_y - 3 && pos.y + ball_radius >= 1)
-			{
-				return CollisionTypes::Right;
-			}
-			else if (pos.x + ball_radius > block_breaker_config.board_dimension_x - 3 && pos.y - ball_radius < 1)
-			{
-				return CollisionTypes::TopRight;
-			}
-			else if (pos.x + ball_radius > block_breaker_config.board_dimension_x - 3 && pos.y + ball_radius > block_breaker_config.board_dimension_y - 3)
-			{
-				return CollisionTypes::BottomRight;
-			}
-			else if (pos.y + ball_radius > block_breaker_config.board_dimension_y - 3)
-			{
-				return CollisionTypes::Bottom;
-			}
-			else if (pos.y - ball_radius < 3)
-			{
-				return CollisionTypes::Top;
-			}
+			return {
+				static_cast<int>(drawn_paddle.x - config.paddle_width / 2),
+				static_cast<int>(drawn_paddle.x + config.paddle_width / 2 - 1),
+				static_cast<int>(drawn_paddle.y) };
+		}
 
-			return CollisionTypes::None;
+		void BoardCanvas::DrawPaddle()
+		{
+			auto [left, right, y] = PaddlePixels();
+			canvas.DrawBlockLine(left, y, right, y);
 		}
 
+		bool BoardCanvas::IsBorderPixel(int x, int y) const
+		{
+			int row = y / 2;
+			int top = 1;
+			int bottom = (canvas.height() - 3) / 2;
+			if (row == top || row == bottom)
+			{
+				return true;
+			}
+			return row > top && row < bottom && (x <= 1 || x >= canvas.width() - 2);
+		}
 
-		void BlockBreaker::HandleCollision(BlockBreakerGameState& game_state, CollisionTypes collision_type, bool collided_border)
+		std::vector<std::uint32_t>* BoardCanvas::BlocksInCell(int x, int y)
 		{
-			switch (collision_type)
+			if (x < 0 || y < 0 || x >= canvas.width() || y >= canvas.height())
 			{
-			case CollisionTypes::Left:
-					game_state.ball_direction = Vector2D::Vector2D(-game_state.ball_direction.x, game_state.ball_direction.y);
-				break;
-			case CollisionTypes::TopLeft:
-			case CollisionTypes::Top:
-			case CollisionTypes::TopRight:
-				game_state.ball_direction = Vector2D::Vector2D(game_state.ball_direction.x, -game_state.ball_direction.y);
-				break;
-			case CollisionTypes::Right:
-				game_state.ball_direction = Vector2D::Vector2D(-game_state.ball_direction.x, game_state.ball_direction.y);
-				break;
-			case CollisionTypes::BottomRight:
-			case CollisionTypes::Bottom:
-			case CollisionTypes::BottomLeft:
-				if (collided_border)
-				{
-					game_state.lost = true;
-				}
-				else
-				{
-					game_state.ball_direction = Vector2D::Vector2D(game_state.ball_direction.x, -game_state.ball_direction.y);
-				}
-				break;
-			case CollisionTypes::None:
-				break;
-			default:
-				break;
+				return nullptr;
 			}
+			return &blocks_by_cell[static_cast<size_t>(y / 4) * columns + x / 2];
 		}
-		
-		bool IntersectsPaddle(BlockBreakerGameState& game_state, float ball_radius)
+
+		void BoardCanvas::RestoreCell(int x, int y, const BlockBreakerSnapshot& snapshot)
 		{
-			if (game_state.ball_direction.y < 0)
+			auto* blocks = BlocksInCell(x, y);
+			if (!blocks)
 			{
-				return false;
+				return;
 			}
-			if (game_state.ball_position.y + ball_radius >= game_state.paddle_position.y - block_breaker_config.paddle_height) // y-coordinate matches
+
+			auto [paddle_left, paddle_right, paddle_y] = PaddlePixels();
+			int cell_x = x / 2 * 2;
+			int cell_y = y / 4 * 4;
+			for (int pixel_x = cell_x; pixel_x < cell_x + 2; ++pixel_x)
 			{
-				return game_state.ball_position.x + ball_radius > game_state.paddle_position.x - block_breaker_config.paddle_width / 2
-					&& game_state.ball_position.x - ball_radius < game_state.paddle_position.x + block_breaker_config.paddle_width / 2;
+				for (int pixel_y = cell_y; pixel_y < cell_y + 4; pixel_y += 2)
+				{
+					bool is_paddle = pixel_y / 2 == paddle_y / 2 && pixel_x >= paddle_left && pixel_x <= paddle_right;
+					if (is_paddle || IsBorderPixel(pixel_x, pixel_y))
+					{
+						canvas.DrawBlock(pixel_x, pixel_y, true);
+					}
+				}
 			}
 
-			return false;
+			for (std::uint32_t index : *blocks)
+			{
+				if (alive[index])
+				{
+					DrawBlock(canvas, snapshot.level_blocks[index]);
+				}
+			}
 		}
 
-		void HandlePaddleCollision(BlockBreakerGameState& game_state)
+		namespace
 		{
-			auto distance_from_paddle_middle = abs(game_state.paddle_position.x - game_state.ball_position.x);
-
-			auto normalized_distance = 1 - (distance_from_paddle_middle / (block_breaker_config.paddle_width / 2));
-			auto theta_new = normalized_distance * (90 - block_breaker_config.min_theta) + block_breaker_config.min_theta;
+			/**
+			 * Scene showing the Block Breaker game. Starts a new game whenever it is entered.
+			 */
+			class BlockBreakerScene : public Scene
+			{
+			public:
+				BlockBreakerScene(CoroutineScheduler& scheduler, QuitFunction quit_function, ReplayRecorder* recorder)
+					: scheduler(scheduler), recorder(recorder)
+				{
+					auto container = ftxui::Container::Vertical({});
 
+					auto game_view_renderer = ftxui::Renderer([this]
+						{
+							ProfileScope profile(ProfilePhase::BoardCanvas);
+							return ftxui::canvas(&board.Update(session.snapshot));
+						});
 
-			auto x_new = cos(DegreesToRadians(theta_new));
-			auto y_new = sin(DegreesToRadians(theta_new));
+					container->Add(game_view_renderer);
 
-			if (game_state.paddle_position.x - game_state.ball_position.x > 0) // ball is to the left side of the paddle center
-			{
-				x_new = -x_new;
-			}
+					// Quit button
+					auto quit_button = ftxui::Button(&quit_button_label, quit_function);
+					container->Add(quit_button);
 
-			auto ball_direction_new = Vector2D::Vector2D(x_new, -y_new) * game_state.ball_speed;
+					// Restart button
+					auto restart_button = ftxui::Button(&restart_button_label, [this] { StartNewGame(); });
+					container->Add(restart_button);
 
-			game_state.ball_speed *= block_breaker_config.speed_increase_factor;
+					auto screen_view_renderer = ftxui::Renderer(container, [=, this] {
+						const BlockBreakerSnapshot& snapshot = session.snapshot;
+						std::string ball_position_text;
+						std::string speed_text;
+						std::string latency_text;
+						{
+							ProfileScope profile(ProfilePhase::StatusText);
+							ball_position_text = std::format("Ball Position: {}", snapshot.ball_position.ToString());
+							speed_text = std::format("Speed: {}", Vector2D::Magnitude(snapshot.ball_direction));
+							latency_text = std::format("Input latency: {:.1f} ms avg, {:.1f} ms max", snapshot.input_latency.average_ms, snapshot.input_latency.max_ms);
+						}
 
-			game_state.ball_direction = Vector2D::Normalize(ball_direction_new) * game_state.ball_speed;
-		}
+						return ftxui::vbox({
+							ftxui::text("Terminal Minigames") | ftxui::bold | ftxui::center,
+							ftxui::text(""),
+							ftxui::hbox({
+								game_view_renderer->Render(),
+								ftxui::vbox({
+									quit_button->Render(),
+									restart_button->Render(),
+									ftxui::filler()
+								})
+							}),
+							ftxui::text(ball_position_text),
+							ftxui::text(speed_text),
+							ftxui::text(latency_text)
+							});
+					});
 
-		CollisionTypes CheckAndHandleBlockCollision(BlockBreakerGameState& game_state, float ball_radius)
-		{
-			CollisionTypes collision_type = CollisionTypes::None;
-			std::unordered_set<Block, boost::hash<Block>> block_positions_new = game_state.block_positions;
+					auto screen_view_event_catch_wrapper = ftxui::CatchEvent(screen_view_renderer, [this](ftxui::Event e) 
+						{ 
+							if (e == ftxui::Event::ArrowLeft || e == ftxui::Event::ArrowRight)
+							{
+								auto direction = e == ftxui::Event::ArrowLeft ? InputDirection::Left : InputDirection::Right;
+
+								// A full channel means the input task is not waiting for inputs, e.g. after the game ended; drop the input
+								session.inputs.Push({ direction, std::chrono::steady_clock::now() });
+								return true;
+							}
+							else if (e == ftxui::Event::ArrowDown || e == ftxui::Event::ArrowUp)
+							{
+								// Catch input but no actions to be done
+								return true;
+							}
+							return false;  
+						});
+
+					root = screen_view_event_catch_wrapper;
+				}
 
-			for (auto& b : game_state.block_positions)
-			{
-				collision_type = TestBlockOverlap(b, game_state.ball_position, ball_radius);
-				if (collision_type != CollisionTypes::None)
+				ftxui::Component Root() override
 				{
-					last_collision = collision_type;
-					block_positions_new.erase(b);
-					break;
+					return root;
 				}
-			}
 
-			if (collision_type != CollisionTypes::None)
-			{
-				game_state.block_positions = block_positions_new;
+				void Enter() override
+				{
+					StartNewGame();
+				}
 
-				if (game_state.block_positions.size() == 0)
+				void Leave() override
 				{
-					game_state.won = true;
+					scheduler.Cancel(update_task);
+					scheduler.Cancel(input_task);
+					session.recording = {};
 				}
 
-				HandleCollision(game_state, collision_type, false);
-			}
+			private:
+				/**
+				 * Replaces the running tasks, if any, with fresh ones, which start a new game.
+				 */
+				void StartNewGame()
+				{
+					Leave();
+					if (recorder)
+					{
+						Replay header;
+						header.game = ReplayGame::BlockBreaker;
+						header.block_breaker_config = session.simulation.Config();
+						header.step_seconds = FixedTimestep(physics_rate).StepSeconds();
+						session.recording = recorder->Record(header);
+					}
+
+					update_task = scheduler.Spawn(UpdateBall(scheduler, session));
+					input_task = scheduler.Spawn(HandlePaddleInput(session));
+				}
 
-			return collision_type;
+				CoroutineScheduler& scheduler;
+				/**
+				 * Recorder to record every game with, if replays are recorded.
+				 */
+				ReplayRecorder* recorder;
+				TaskId update_task = 0;
+				TaskId input_task = 0;
+				BlockBreakerSession session;
+				BoardCanvas board{ session.simulation.Config() };
+
+				std::string quit_button_label = "Back to Menu";
+				std::string restart_button_label = "Restart";
+				ftxui::Component root;
+			};
 		}
 
-		CollisionTypes TestBlockOverlap(Block b, Vector2D::Vector2D v, float ball_radius)
+		std::unique_ptr<Scene> CreateBlockBreakerScene(CoroutineScheduler& scheduler, QuitFunction quit_function, ReplayRecorder* recorder)
 		{
-			double d1x = b.end_left.x - v.x + ball_radius;
-			double d1y = b.end_left.y - v.y + ball_radius;
-			double d2x = (v.x - ball_radius) - b.end_right.x;
-			double d2y = (v.y - ball_radius) - b.end_right.y;
-
-			if (d1x > 0.0f || d1y > 0.0f) // compare to top left corner of block
-			{
-				return CollisionTypes::None;
-			}
-
-			if (d2x > 0.0f || d2y > 0.0f) // compare to bottom right corner of block
-			{
-				return CollisionTypes::None;
-			}
-
-			// Check collision with a block's bottom border:
-			auto p1 = Vector2D::Vector2D(b.end_left.x, b.end_right.y);
-			auto p2 = Vector2D::Vector2D(b.end_right.x, b.end_right.y);
-			if (LineSegmentsIntersect(p1, p2, game_state.ball_position_prev, game_state.ball_position + Vector2D::Vector2D(0, -ball_radius)))
-			{
-				return CollisionTypes::Top; // from ball's view collision is top (like with top border)
-			}
-
-			// Check top border:
-			p1 = Vector2D::Vector2D(b.end_left.x, b.end_left.y);
-			p2 = Vector2D::Vector2D(b.end_right.x, b.end_left.y);
-			if (LineSegmentsIntersect(p1, p2, game_state.ball_position_prev, game_state.ball_position + Vector2D::Vector2D(0, ball_radius)))
-			{
-				return CollisionTypes::Bottom;
-			}
-
-			// Check left border:
-			p1 = Vector2D::Vector2D(b.end_left.x, b.end_left.y);
-			p2 = Vector2D::Vector2D(b.end_left.x, b.end_right.y);
-			if (LineSegmentsIntersect(p1, p2, game_state.ball_position_prev, game_state.ball_position + Vector2D::Vector2D(ball_radius, 0)))
-			{
-				return CollisionTypes::Right;
-			}
-
-			// Check right border:
-			p1 = Vector2D::Vector2D(b.end_right.x, b.end_left.y);
-			p2 = Vector2D::Vector2D(b.end_right.x, b.end_right.y);
-			if (LineSegmentsIntersect(p1, p2, game_state.ball_position_prev, game_state.ball_position + Vector2D::Vector2D(-ball_radius, 0)))
-			{
-				return CollisionTypes::Left;
-			}
-
-			return CollisionTypes::None;
+			return std::make_unique<BlockBreakerScene>(scheduler, std::move(quit_function), recorder);
 		}
 
 	} // namespace BlockBreaker
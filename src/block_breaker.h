@@ -1,215 +1,193 @@
 #pragma once
 
-#include <unordered_set>
-
-#include "boost/container_hash/hash.hpp"
-#include "ftxui/component/screen_interactive.hpp"
-
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <vector>
+
+#include "ftxui/dom/canvas.hpp"
+
+#include "block_breaker_simulation.h"
+#include "replay.h"
+#include "scene_manager.h"
+#include "util/coroutine_scheduler.h"
+#include "util/input_direction.h"
+#include "util/latency_stats.h"
 #include "util/util.h"
-#include "util/vector2d.h"
 
 namespace TerminalMinigames
 {
 	namespace BlockBreaker
 	{
 		/**
-		 * Block structure representing the blocks to destroy during the game.
+		 * Everything needed to draw one frame of the game. Brought up to date by the update task once per frame
+		 * and read when drawing, so drawing does not depend on the simulation's internal state.
 		 */
-		struct Block
+		struct BlockBreakerSnapshot
 		{
 			/**
-			 * Vector pointing to the top left corner of the block.
+			 * Number of the game the snapshot belongs to. Changes whenever a new game is started.
 			 */
-			Vector2D::Vector2D end_left;
-
+			std::uint64_t game = 0;
+			Vector2D::Vector2D paddle_position;
 			/**
-			 * Vector pointing to the bottom right corner of the block.
+			 * Position of the ball, interpolated to the time the snapshot was published.
 			 */
-			Vector2D::Vector2D end_right;
+			Vector2D::Vector2D ball_position;
+			Vector2D::Vector2D ball_direction;
+			/**
+			 * All blocks of the level, destroyed or not.
+			 */
+			std::vector<Block> level_blocks;
+			/**
+			 * Indices of the destroyed blocks in the order they were destroyed.
+			 */
+			std::vector<std::uint32_t> destroyed_blocks;
+			bool lost = false;
+			bool won = false;
+			LatencyStats input_latency;
+		};
+
+		/**
+		 * Draw function to draw the given block on the given canvas.
+		 */
+		void DrawBlock(ftxui::Canvas& canvas, const Block& block);
 
-			Block() = default;
-			Block(Vector2D::Vector2D left_endpoint, Vector2D::Vector2D right_endpoint) : end_left(left_endpoint), end_right(right_endpoint) {};
+		/**
+		 * Erase function to clear the pixels drawn by DrawBlock for the given block.
+		 */
+		void EraseBlock(ftxui::Canvas& canvas, const Block& block);
+
+		/**
+		 * Brings the given snapshot up to date with the simulation's current state. The level is only copied once per
+		 * game, afterwards only the blocks destroyed since the snapshot was last captured are added.
+		 *
+		 * @param simulation Simulation to capture.
+		 * @param game Number of the simulation's current game.
+		 * @param alpha Fraction of a physics step passed since the last step, to interpolate the ball position with.
+		 * @param snapshot Snapshot to update. Its input latency is left unchanged.
+		 */
+		void CaptureSnapshot(const BlockBreakerSimulation& simulation, std::uint64_t game, double alpha, BlockBreakerSnapshot& snapshot);
 
-			bool operator ==(const Block& other) const
+		/**
+		 * Board of the game drawn into a canvas that is kept between frames. Only the ball, the paddle and the blocks
+		 * destroyed since the last drawn snapshot are drawn again, so a frame costs the same no matter how many blocks there are.
+		 * The whole board is only drawn again when a new game starts and when the game ends.
+		 */
+		class BoardCanvas
+		{
+		public:
+			/**
+			 * @param config Configuration of the games to draw, defining the board and paddle size.
+			 */
+			explicit BoardCanvas(const BlockBreakerConfig& config) : config(config)
 			{
-				return end_left == other.end_left && end_right == other.end_right;
 			}
 
-			friend size_t hash_value(const Block& b)
+			/**
+			 * Brings the canvas up to date with the given snapshot.
+			 */
+			const ftxui::Canvas& Update(const BlockBreakerSnapshot& snapshot);
+
+		private:
+			struct PaddleLine
 			{
-				size_t seed = 0;
+				int left;
+				int right;
+				int y;
+			};
 
-				boost::hash<Vector2D::Vector2D> vector_hasher;
+			void Rebuild(const BlockBreakerSnapshot& snapshot);
+			void ApplyChanges(const BlockBreakerSnapshot& snapshot);
+			PaddleLine PaddlePixels() const;
+			void DrawPaddle();
+			bool IsBorderPixel(int x, int y) const;
+
+			/**
+			 * Blocks drawn into the text cell containing the given pixel, if the pixel is on the canvas.
+			 */
+			std::vector<std::uint32_t>* BlocksInCell(int x, int y);
 
-				boost::hash_combine(seed, vector_hasher(b.end_left));
-				boost::hash_combine(seed, vector_hasher(b.end_right));
+			/**
+			 * Draws the border, paddle and alive blocks within the text cell containing the given pixel again.
+			 */
+			void RestoreCell(int x, int y, const BlockBreakerSnapshot& snapshot);
 
-				return seed;
-			}
+			BlockBreakerConfig config;
+			ftxui::Canvas canvas;
 
 			/**
-			 * Draw function to draw the block on the given canvas.
+			 * State of the game the canvas shows. The game number starts out invalid so the first update draws the whole board.
 			 */
-			void Draw(ftxui::Canvas& canvas);
+			std::uint64_t drawn_game = std::numeric_limits<std::uint64_t>::max();
+			bool drawn_over = false;
+			Vector2D::Vector2D drawn_paddle;
+			Vector2D::Vector2D drawn_ball;
+			size_t drawn_destroyed = 0;
+			std::vector<bool> alive;
+
+			int columns = 0;
+			std::vector<std::vector<std::uint32_t>> blocks_by_cell;
 		};
 
 		/**
-		 * Game state describing structure.
+		 * Game played by a Block Breaker scene: the simulation and the state its tasks share with the scene.
+		 * Only accessed by the UI thread, which runs the tasks.
 		 */
-		struct BlockBreakerGameState
+		struct BlockBreakerSession
 		{
 			/**
-			 * Position of the paddle.
-			 */
-			Vector2D::Vector2D paddle_position;
-			/**
-			 * Position of the ball.
+			 * Simulation driven by the game's tasks.
 			 */
-			Vector2D::Vector2D ball_position;
+			BlockBreakerSimulation simulation;
 			/**
-			 * Previous position of the ball.
-			 * Required for the collision detection.
+			 * State of the simulation at the latest frame, which the board and status lines are drawn from.
 			 */
-			Vector2D::Vector2D ball_position_prev;
+			BlockBreakerSnapshot snapshot;
 			/**
-			 * Direction vector for the ball trajectory.
+			 * Paddle inputs caught by the UI, in order, to be applied by the input task.
 			 */
-			Vector2D::Vector2D ball_direction;
+			EventChannel<InputEvent, 64> inputs;
 			/**
-			 * Speed value equaling the magnitude of the ball_direction vector.
+			 * Recording of the paddle inputs of the current game, which records nothing unless replays are recorded.
 			 */
-			float ball_speed = 10.f;
-
+			ReplayRecording recording;
 			/**
-			 * Set of blocks to destroy.
+			 * Time from catching an input until the input task applied it.
 			 */
-			std::unordered_set<Block, boost::hash<Block>> block_positions;
-
-			InputDirection last_input = InputDirection::None;
-
-			bool lost = false;
-			bool won = false;
-
+			LatencyStats input_latency;
 			/**
-			 * Resets the game state for a new start of the game.
+			 * Number of games started.
 			 */
-			void Reset();
+			std::uint64_t game_count = 0;
 		};
 
 		/**
-		 * Main function for the Block Breaker game.
+		 * Creates the scene of the Block Breaker game. A new game is started whenever the scene is entered
+		 * and its tasks are cancelled when the scene is left.
 		 * 
+		 * @param scheduler Scheduler of the UI thread to run the game's tasks on.
 		 * @param quit_function Function to execute on the Quit/Back to menu button.
-		 * @param back_to_menu Pointer to back flag in the main menu to display main menu again.
-		 */
-		void ExecuteBlockBreaker(QuitFunction quit_function, bool* back_to_menu);
-
-		/**
-		 * Update function to update the ball in an individual thread.
-		 * 
-		 * @param screen Screen reference to post events to to signal ball position's updates.
-		 * @param state Game state reference.
-		 * @param back_flag Boolean flag to signal returning back to the menu.
-		 */
-		void UpdateBall(ftxui::ScreenInteractive& screen, BlockBreakerGameState& state, bool* back_flag);
-
-		/**
-		 * Update function to refresh the screen.
-		 * 
-		 * @param screen Screen reference to trigger looping.
-		 * @param comp UI component to display on the screen.
-		 */
-		void UpdateScreen(ftxui::ScreenInteractive& screen, ftxui::Component& comp);
-
-		/**
-		 * Enum listing the collision types.
-		 */
-		enum class CollisionTypes
-		{
-			Left,
-			TopLeft,
-			Top,
-			TopRight,
-			Right,
-			BottomRight,
-			Bottom,
-			BottomLeft,
-			None
-		};
-
-		/**
-		 * Transforms the given collision type into a printable string.
-		 * 
-		 * @param c Collision type to transform into string.
-		 * @returns String for the collision type.
-		 */
-		inline const std::string ToString(CollisionTypes c)
-		{
-			switch (c)
-			{
-			case CollisionTypes::Left:			return "Left";
-			case CollisionTypes::TopLeft:		return "Top Left";
-			case CollisionTypes::TopRight:		return "Top Right";
-			case CollisionTypes::Right:			return "Right";
-			case CollisionTypes::BottomLeft:	return "Bottom Left";
-			case CollisionTypes::BottomRight:	return "Bottom Right";
-			case CollisionTypes::Top:			return "Top";
-			case CollisionTypes::Bottom:		return "Bottom";
-			case CollisionTypes::None:			return "None";
-			}
-		}
-
-		/**
-		 * Checks whether the ball at the given position with the given radius intersects with the game canvas's borders.
-		 * 
-		 * @param pos Position vector of the ball.
-		 * @param ball_radius Radius of the ball.
-		 * @returns The type of collision that has occurred.
-		 */
-		CollisionTypes IntersectsBorder(Vector2D::Vector2D& pos, float ball_radius);
-
-		/**
-		 * Handles the ball's collision with an object, i.e. applies direction changes.
-		 * 
-		 * @param game_state Current state of the game.
-		 * @param collision_type Type of collision that has occurred.
-		 * @param collided_border Whether the ball collided with a border of the canvas.
-		 */
-		void HandleCollision(BlockBreakerGameState& game_state, CollisionTypes collision_type, bool collided_border);
-
-		/**
-		 * Checks whether the ball collides with the paddle controlled by the player.
-		 * 
-		 * @param game_state Current game state describing ball & paddle positions.
-		 * @param ball_radius Ball's radius.
-		 * @returns Whether the ball intersects with the paddle.
-		 */
-		bool IntersectsPaddle(BlockBreakerGameState& game_state, float ball_radius);
-
-		/**
-		 * Handles the collision of the ball with the paddle.
-		 * 
-		 * @param game_state Current game state.
+		 * @param recorder Recorder to record a replay of every game with, or null to record none.
 		 */
-		void HandlePaddleCollision(BlockBreakerGameState& game_state);
+		std::unique_ptr<Scene> CreateBlockBreakerScene(CoroutineScheduler& scheduler, QuitFunction quit_function, ReplayRecorder* recorder);
 
 		/**
-		 * Checks and handles collisions between ball and block.
+		 * Update task of the ball. Starts a new game, steps the physics at a fixed rate
+		 * and catches up in whole steps after the task was resumed late. Updates the snapshot for every frame.
+		 * Each physics step is one tick of the game's replay recording.
 		 * 
-		 * @param game_state Current game state.
-		 * @param ball_radius Radius of the ball.
-		 * @returns Type of collision that occurred with the hit block.
+		 * @param scheduler Scheduler the task runs on.
+		 * @param session Session whose simulation to step, and whose snapshot and recording to update.
 		 */
-		CollisionTypes CheckAndHandleBlockCollision(BlockBreakerGameState& game_state, float ball_radius);
+		Task UpdateBall(CoroutineScheduler& scheduler, BlockBreakerSession& session);
 
 		/**
-		 * Checks whether the ball at the given position with the given radius overlaps with the given block.
+		 * Input task moving the paddle as soon as an input is caught, for as long as the game is running.
+		 * Each move is recorded before the next physics step, which is where a replay applies it again.
 		 * 
-		 * @param b Block object to check overlap for.
-		 * @param v Ball position.
-		 * @param ball_radius Radius of the ball.
-		 * @returns Type of collision between ball and block.
+		 * @param session Session whose inputs to apply to its simulation's paddle and to its recording.
 		 */
-		CollisionTypes TestBlockOverlap(Block b, Vector2D::Vector2D v, float ball_radius);
+		Task HandlePaddleInput(BlockBreakerSession& session);
 	} // namespace BlockBreaker
-} // namespace TerminalMinigames
\ No newline at end of file
+} // namespace TerminalMinigames
@@ -0,0 +1,403 @@
+#include <cmath>
+#include <limits>
+
+#include "block_breaker_simulation.h"
+#include "util/geometry.h"
+
+namespace TerminalMinigames
+{
+	namespace BlockBreaker
+	{
+		std::vector<Block> CreateLevel(int rows, int columns)
+		{
+			std::vector<Block> level;
+			level.reserve(static_cast<size_t>(rows) * columns);
+
+			for (int row = 0; row < rows; ++row)
+			{
+				double y = 6.f + row * 6.f;
+				for (int column = 0; column < columns; ++column)
+				{
+					double x = 4.f + column * 8.f;
+					level.emplace_back(Vector2D::Vector2D(x, y), Vector2D::Vector2D(x + 5.f, y + 2.f));
+				}
+			}
+
+			return level;
+		}
+
+		BlockBreakerSimulation::BlockBreakerSimulation(BlockBreakerConfig config) : config(config)
+		{
+			Reset();
+		}
+
+		void BlockBreakerSimulation::Reset()
+		{
+			Reset(CreateLevel());
+		}
+
+		void BlockBreakerSimulation::Reset(const std::vector<Block>& level)
+		{
+			state.blocks.Assign(level);
+			state.block_grid.Build(config.board_dimension_x, config.board_dimension_y, config.broadphase_cell_size, state.blocks);
+			state.overlap_candidates.resize(state.block_grid.MaxCellSize());
+			state.destroyed_blocks.clear();
+			state.destroyed_blocks.reserve(level.size());
+
+			state.paddle_position = config.paddle_start_position;
+			state.ball_position = { state.paddle_position.x, state.paddle_position.y - config.paddle_height - 2 };
+			state.ball_position_prev = state.ball_position;
+			state.ball_direction = { 0, -config.ball_speed_initial };
+			state.ball_speed = config.ball_speed_initial;
+
+			state.lost = false;
+			state.won = false;
+		}
+
+		void BlockBreakerSimulation::MovePaddle(InputDirection input)
+		{
+			if (input == InputDirection::Left)
+			{
+				if (state.paddle_position.x - config.paddle_step_size >= 1 + config.paddle_width / 2)
+				{
+					state.paddle_position.x -= config.paddle_step_size;
+				}
+			}
+			else if (input == InputDirection::Right)
+			{
+				if (state.paddle_position.x + config.paddle_step_size <= config.board_dimension_x - 2 - config.paddle_width / 2)
+				{
+					state.paddle_position.x += config.paddle_step_size;
+				}
+			}
+		}
+
+		void BlockBreakerSimulation::Step(double dt)
+		{
+			if (IsOver())
+			{
+				return;
+			}
+
+			state.ball_position_prev = state.ball_position;
+
+			// Move the ball from contact to contact, so fast balls cannot pass through anything within one step
+			double remaining_time = dt;
+			for (int collision = 0; collision < config.max_collisions_per_step && remaining_time > 0; ++collision)
+			{
+				auto displacement = state.ball_direction * remaining_time;
+
+				BallContact contact = SweepBallAgainstBorder(config, state.ball_position, displacement, config.ball_radius);
+
+				BallContact paddle_contact = SweepBallAgainstPaddle(config, state, displacement);
+				if (paddle_contact.IsBefore(contact))
+				{
+					contact = paddle_contact;
+				}
+
+				BallContact block_contact = FindBlockContact(config, state, displacement);
+				if (block_contact.IsBefore(contact))
+				{
+					contact = block_contact;
+				}
+
+				if (contact.target == ContactTarget::None)
+				{
+					state.ball_position += displacement;
+					break;
+				}
+
+				state.ball_position += displacement * contact.time;
+				remaining_time -= remaining_time * contact.time;
+
+				HandleContact(config, state, contact);
+				if (IsOver())
+				{
+					break;
+				}
+			}
+		}
+
+		BallContact SweepBallAgainstBorder(const BlockBreakerConfig& config, const Vector2D::Vector2D& pos, const Vector2D::Vector2D& displacement, double ball_radius)
+		{
+			BallContact contact;
+
+			// Each border is a line the ball's center cannot cross. A ball already past a border touches it right away.
+			auto sweep = [&](double position, double movement, double border, CollisionTypes type)
+				{
+					double time = std::max((border - position) / movement, 0.0);
+					BallContact border_contact = { time, ContactTarget::Border, type };
+					if (time <= 1.0 && border_contact.IsBefore(contact))
+					{
+						contact = border_contact;
+					}
+				};
+
+			if (displacement.x < 0)
+			{
+				sweep(pos.x, displacement.x, 2 + ball_radius, CollisionTypes::Left);
+			}
+			else if (displacement.x > 0)
+			{
+				sweep(pos.x, displacement.x, config.board_dimension_x - 3 - ball_radius, CollisionTypes::Right);
+			}
+
+			if (displacement.y < 0)
+			{
+				sweep(pos.y, displacement.y, 3 + ball_radius, CollisionTypes::Top);
+			}
+			else if (displacement.y > 0)
+			{
+				sweep(pos.y, displacement.y, config.board_dimension_y - 3 - ball_radius, CollisionTypes::Bottom);
+			}
+
+			return contact;
+		}
+
+		void HandleCollision(BlockBreakerGameState& game_state, CollisionTypes collision_type, bool collided_border)
+		{
+			switch (collision_type)
+			{
+			case CollisionTypes::Left:
+					game_state.ball_direction = Vector2D::Vector2D(-game_state.ball_direction.x, game_state.ball_direction.y);
+				break;
+			case CollisionTypes::TopLeft:
+			case CollisionTypes::Top:
+			case CollisionTypes::TopRight:
+				game_state.ball_direction = Vector2D::Vector2D(game_state.ball_direction.x, -game_state.ball_direction.y);
+				break;
+			case CollisionTypes::Right:
+				game_state.ball_direction = Vector2D::Vector2D(-game_state.ball_direction.x, game_state.ball_direction.y);
+				break;
+			case CollisionTypes::BottomRight:
+			case CollisionTypes::Bottom:
+			case CollisionTypes::BottomLeft:
+				if (collided_border)
+				{
+					game_state.lost = true;
+				}
+				else
+				{
+					game_state.ball_direction = Vector2D::Vector2D(game_state.ball_direction.x, -game_state.ball_direction.y);
+				}
+				break;
+			case CollisionTypes::None:
+				break;
+			default:
+				break;
+			}
+		}
+
+		BallContact SweepBallAgainstPaddle(const BlockBreakerConfig& config, const BlockBreakerGameState& game_state, const Vector2D::Vector2D& displacement)
+		{
+			if (displacement.y <= 0)
+			{
+				return {};
+			}
+
+			// The ball bounces off the paddle's top only, as soon as its bottom reaches it. A ball that already passed
+			// the top is lost even if it overlaps the paddle, instead of being caught and pushed out of the paddle's side.
+			double paddle_top = game_state.paddle_position.y - config.paddle_height - config.ball_radius;
+			if (game_state.ball_position.y > paddle_top)
+			{
+				return {};
+			}
+
+			double time = (paddle_top - game_state.ball_position.y) / displacement.y;
+			if (time > 1.0)
+			{
+				return {};
+			}
+
+			double x = game_state.ball_position.x + displacement.x * time;
+			if (x + config.ball_radius > game_state.paddle_position.x - config.paddle_width / 2
+				&& x - config.ball_radius < game_state.paddle_position.x + config.paddle_width / 2)
+			{
+				return { time, ContactTarget::Paddle, CollisionTypes::Bottom };
+			}
+
+			return {};
+		}
+
+		void HandlePaddleCollision(const BlockBreakerConfig& config, BlockBreakerGameState& game_state)
+		{
+			auto distance_from_paddle_middle = std::abs(game_state.paddle_position.x - game_state.ball_position.x);
+
+			auto normalized_distance = 1 - (distance_from_paddle_middle / (config.paddle_width / 2));
+			auto theta_new = normalized_distance * (90 - config.min_theta) + config.min_theta;
+
+
+			auto x_new = cos(DegreesToRadians(theta_new));
+			auto y_new = sin(DegreesToRadians(theta_new));
+
+			if (game_state.paddle_position.x - game_state.ball_position.x > 0) // ball is to the left side of the paddle center
+			{
+				x_new = -x_new;
+			}
+
+			auto ball_direction_new = Vector2D::Vector2D(x_new, -y_new) * game_state.ball_speed;
+
+			game_state.ball_speed = std::min(game_state.ball_speed * config.speed_increase_factor, config.ball_speed_max);
+
+			game_state.ball_direction = Vector2D::Normalize(ball_direction_new) * game_state.ball_speed;
+		}
+
+		BallContact SweepBallAgainstBlock(const Block& b, const Vector2D::Vector2D& pos, const Vector2D::Vector2D& displacement, double ball_radius)
+		{
+			// Slab test of the ball's center against the block grown by the ball radius
+			double entry_time = -std::numeric_limits<double>::infinity();
+			double exit_time = std::numeric_limits<double>::infinity();
+			int entry_axis = -1;
+
+			for (int axis = 0; axis < 2; ++axis)
+			{
+				double low = b.end_left[axis] - ball_radius;
+				double high = b.end_right[axis] + ball_radius;
+
+				if (displacement[axis] == 0)
+				{
+					if (pos[axis] < low || pos[axis] > high)
+					{
+						return {};
+					}
+					continue;
+				}
+
+				double time_low = (low - pos[axis]) / displacement[axis];
+				double time_high = (high - pos[axis]) / displacement[axis];
+				if (time_low > time_high)
+				{
+					std::swap(time_low, time_high);
+				}
+
+				if (time_low > entry_time)
+				{
+					entry_time = time_low;
+					entry_axis = axis;
+				}
+				exit_time = std::min(exit_time, time_high);
+			}
+
+			// Ignore blocks that are missed or out of reach within the step
+			if (entry_axis < 0 || entry_time > exit_time || entry_time > 1 || exit_time < 0)
+			{
+				return {};
+			}
+
+			auto contact_position = pos + displacement * std::max(entry_time, 0.0);
+			bool beside_block = contact_position.x < b.end_left.x || contact_position.x > b.end_right.x;
+			bool above_or_below_block = contact_position.y < b.end_left.y || contact_position.y > b.end_right.y;
+
+			if (!beside_block || !above_or_below_block)
+			{
+				// Ignore blocks the ball is already inside of
+				if (entry_time < 0)
+				{
+					return {};
+				}
+
+				// Hit a side of the block
+				if (entry_axis == 0)
+				{
+					return { entry_time, ContactTarget::Block, displacement.x > 0 ? CollisionTypes::Right : CollisionTypes::Left };
+				}
+				return { entry_time, ContactTarget::Block, displacement.y > 0 ? CollisionTypes::Bottom : CollisionTypes::Top };
+			}
+
+			// The grown block has rounded corners: intersect the center's path with the circle around the corner
+			Vector2D::Vector2D corner(
+				std::clamp(contact_position.x, b.end_left.x, b.end_right.x),
+				std::clamp(contact_position.y, b.end_left.y, b.end_right.y));
+			auto offset = pos - corner;
+
+			double a = displacement.x * displacement.x + displacement.y * displacement.y;
+			double half_b = offset.x * displacement.x + offset.y * displacement.y;
+			double c = offset.x * offset.x + offset.y * offset.y - ball_radius * ball_radius;
+			double discriminant = half_b * half_b - a * c;
+			if (c < 0 || discriminant < 0)
+			{
+				return {};
+			}
+
+			double time = (-half_b - std::sqrt(discriminant)) / a;
+			if (time < 0 || time > 1)
+			{
+				return {};
+			}
+
+			// Reflect along the axis the ball hits the corner more directly on, as long as the ball moves towards the block on it
+			auto normal = offset + displacement * time;
+			bool towards_x = displacement.x * normal.x < 0;
+			bool towards_y = displacement.y * normal.y < 0;
+			if (towards_x && (!towards_y || std::abs(normal.x) >= std::abs(normal.y)))
+			{
+				return { time, ContactTarget::Block, displacement.x > 0 ? CollisionTypes::Right : CollisionTypes::Left };
+			}
+			return { time, ContactTarget::Block, displacement.y > 0 ? CollisionTypes::Bottom : CollisionTypes::Top };
+		}
+
+		BallContact FindBlockContact(const BlockBreakerConfig& config, BlockBreakerGameState& game_state, const Vector2D::Vector2D& displacement)
+		{
+			BallContact contact;
+			double ball_radius = config.ball_radius;
+			const auto& start = game_state.ball_position;
+
+			// Only test the blocks in the grid cells overlapped by the ball's movement within the step
+			Vector2D::Vector2D swept_min(
+				std::min(start.x, start.x + displacement.x) - ball_radius,
+				std::min(start.y, start.y + displacement.y) - ball_radius);
+			Vector2D::Vector2D swept_max(
+				std::max(start.x, start.x + displacement.x) + ball_radius,
+				std::max(start.y, start.y + displacement.y) + ball_radius);
+
+			BoxArrays boxes = game_state.blocks.Boxes();
+			game_state.block_grid.ForEachCell(swept_min, swept_max, [&](std::span<const std::uint32_t> cell)
+				{
+					// Filter the cell's blocks by the swept bounds in bulk, then sweep the ball against the remaining ones
+					size_t overlapping = FilterOverlappingBoxes(config.overlap_kernel, boxes, cell,
+						swept_min.x, swept_min.y, swept_max.x, swept_max.y, game_state.overlap_candidates.data());
+
+					for (size_t candidate = 0; candidate < overlapping; ++candidate)
+					{
+						std::uint32_t index = game_state.overlap_candidates[candidate];
+						BallContact block_contact = SweepBallAgainstBlock(game_state.blocks.Get(index), start, displacement, ball_radius);
+						if (block_contact.IsBefore(contact))
+						{
+							contact = block_contact;
+							contact.block = index;
+						}
+					}
+					return false;
+				});
+
+			return contact;
+		}
+
+		void HandleContact(const BlockBreakerConfig& config, BlockBreakerGameState& game_state, const BallContact& contact)
+		{
+			switch (contact.target)
+			{
+			case ContactTarget::Border:
+				HandleCollision(game_state, contact.type, true);
+				break;
+			case ContactTarget::Paddle:
+				HandlePaddleCollision(config, game_state);
+				break;
+			case ContactTarget::Block:
+				game_state.blocks.Destroy(contact.block);
+				game_state.destroyed_blocks.push_back(contact.block);
+				game_state.block_grid.Remove(game_state.blocks.Get(contact.block), contact.block);
+
+				if (game_state.blocks.alive_count == 0)
+				{
+					game_state.won = true;
+				}
+
+				HandleCollision(game_state, contact.type, false);
+				break;
+			case ContactTarget::None:
+				break;
+			}
+		}
+	} // namespace BlockBreaker
+} // namespace TerminalMinigames
@@ -0,0 +1,607 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "boost/container_hash/hash.hpp"
+
+#include "util/box_overlap.h"
+#include "util/input_direction.h"
+#include "util/vector2d.h"
+
+namespace TerminalMinigames
+{
+	namespace BlockBreaker
+	{
+		/**
+		 * Block structure representing the blocks to destroy during the game.
+		 */
+		struct Block
+		{
+			/**
+			 * Vector pointing to the top left corner of the block.
+			 */
+			Vector2D::Vector2D end_left;
+
+			/**
+			 * Vector pointing to the bottom right corner of the block.
+			 */
+			Vector2D::Vector2D end_right;
+
+			Block() = default;
+			Block(Vector2D::Vector2D left_endpoint, Vector2D::Vector2D right_endpoint) : end_left(left_endpoint), end_right(right_endpoint) {};
+
+			bool operator ==(const Block& other) const
+			{
+				return end_left == other.end_left && end_right == other.end_right;
+			}
+
+			friend size_t hash_value(const Block& b)
+			{
+				size_t seed = 0;
+
+				boost::hash<Vector2D::Vector2D> vector_hasher;
+
+				boost::hash_combine(seed, vector_hasher(b.end_left));
+				boost::hash_combine(seed, vector_hasher(b.end_right));
+
+				return seed;
+			}
+		};
+
+		/**
+		 * Struct containing all necessary settings/configurations for the block breaker game.
+		 */
+		struct BlockBreakerConfig
+		{
+			int board_dimension_x = 102;
+			int board_dimension_y = 100;
+
+			int paddle_width = 14;
+			int paddle_height = 1;
+			int paddle_step_size = 2;
+			Vector2D::Vector2D paddle_start_position = { 47, 88 };
+
+			float ball_speed_initial = 10.f;
+			float ball_radius = 0.5f;
+
+			/**
+			 * Factor by which the ball speed is multiplied by for each paddle contact.
+			 */
+			float speed_increase_factor = 1.01f;
+
+			/**
+			 * Upper bound for the ball speed. Since the ball cannot pass through the paddle anymore, endless rallies would otherwise
+			 * speed it up without limit.
+			 */
+			float ball_speed_max = 5000.f;
+
+			/**
+			 * Minimum angle theta that the ball will be returned at from the paddle.
+			 */
+			float min_theta = 20.f;
+
+			/**
+			 * Edge length of the square cells of the broadphase grid over the blocks.
+			 */
+			double broadphase_cell_size = 8.0;
+
+			/**
+			 * Kernel testing the ball against the blocks of a broadphase cell. Defaults to the fastest one the CPU supports.
+			 */
+			OverlapKernel overlap_kernel = BestOverlapKernel();
+
+			/**
+			 * Maximum number of collisions resolved within one step. Any movement left after that is dropped for the step.
+			 */
+			int max_collisions_per_step = 8;
+		};
+
+		/**
+		 * Storage of the blocks of a level as one array per edge coordinate, so the narrowphase can test
+		 * several blocks per SIMD instruction. Blocks keep their index for the whole game and are only flagged
+		 * as destroyed, so destroying a block neither moves nor copies any other block.
+		 */
+		struct BlockSet
+		{
+			/**
+			 * Edge coordinates of all blocks of the level, including destroyed ones.
+			 */
+			std::vector<double> left;
+			std::vector<double> top;
+			std::vector<double> right;
+			std::vector<double> bottom;
+			/**
+			 * Flag per block whether it has not been destroyed yet.
+			 */
+			std::vector<std::uint8_t> alive;
+			/**
+			 * Number of blocks that have not been destroyed yet.
+			 */
+			size_t alive_count = 0;
+
+			/**
+			 * Replaces the blocks with the given level. Reuses the existing storage if it is large enough.
+			 *
+			 * @param level Blocks to store.
+			 */
+			void Assign(const std::vector<Block>& level)
+			{
+				left.resize(level.size());
+				top.resize(level.size());
+				right.resize(level.size());
+				bottom.resize(level.size());
+				for (size_t index = 0; index < level.size(); ++index)
+				{
+					left[index] = level[index].end_left.x;
+					top[index] = level[index].end_left.y;
+					right[index] = level[index].end_right.x;
+					bottom[index] = level[index].end_right.y;
+				}
+
+				alive.assign(level.size(), 1);
+				alive_count = level.size();
+			}
+
+			size_t Size() const
+			{
+				return left.size();
+			}
+
+			Block Get(std::uint32_t index) const
+			{
+				return Block(Vector2D::Vector2D(left[index], top[index]), Vector2D::Vector2D(right[index], bottom[index]));
+			}
+
+			BoxArrays Boxes() const
+			{
+				return { left.data(), top.data(), right.data(), bottom.data() };
+			}
+
+			bool IsAlive(std::uint32_t index) const
+			{
+				return alive[index] != 0;
+			}
+
+			void Destroy(std::uint32_t index)
+			{
+				alive[index] = 0;
+				--alive_count;
+			}
+
+			/**
+			 * Calls the given function for every block that has not been destroyed yet.
+			 */
+			template <typename Function>
+			void ForEachAlive(Function function) const
+			{
+				for (std::uint32_t index = 0; index < Size(); ++index)
+				{
+					if (alive[index])
+					{
+						function(Get(index));
+					}
+				}
+			}
+		};
+
+		/**
+		 * Uniform grid over the board used as broadphase for ball-vs-block collisions.
+		 * Each cell lists the blocks whose rectangle overlaps it, so a collision check only has to
+		 * test the blocks in the cells overlapped by the ball's swept bounds instead of all blocks.
+		 */
+		struct BlockGrid
+		{
+			double cell_size = 8.0;
+			int columns = 0;
+			int rows = 0;
+
+			/**
+			 * Row-major list of the indices of the blocks overlapping each cell.
+			 */
+			std::vector<std::vector<std::uint32_t>> cells;
+
+			/**
+			 * Rebuilds the grid for a board of the given dimensions from the alive blocks of the given set.
+			 * Keeps the storage of the cells if the dimensions did not change.
+			 *
+			 * @param board_width Width of the board.
+			 * @param board_height Height of the board.
+			 * @param new_cell_size Edge length of a cell.
+			 * @param block_set Blocks to insert.
+			 */
+			void Build(int board_width, int board_height, double new_cell_size, const BlockSet& block_set)
+			{
+				int new_columns = static_cast<int>(std::ceil(board_width / new_cell_size)) + 1;
+				int new_rows = static_cast<int>(std::ceil(board_height / new_cell_size)) + 1;
+
+				if (new_columns != columns || new_rows != rows)
+				{
+					cells.assign(static_cast<size_t>(new_columns) * new_rows, {});
+				}
+				else
+				{
+					for (auto& cell : cells)
+					{
+						cell.clear();
+					}
+				}
+
+				cell_size = new_cell_size;
+				columns = new_columns;
+				rows = new_rows;
+
+				for (std::uint32_t index = 0; index < block_set.Size(); ++index)
+				{
+					if (block_set.IsAlive(index))
+					{
+						Insert(block_set.Get(index), index);
+					}
+				}
+			}
+
+			void Insert(const Block& block, std::uint32_t index)
+			{
+				int min_column, min_row, max_column, max_row;
+				CellRange(block.end_left, block.end_right, min_column, min_row, max_column, max_row);
+
+				for (int row = min_row; row <= max_row; ++row)
+				{
+					for (int column = min_column; column <= max_column; ++column)
+					{
+						cells[row * columns + column].push_back(index);
+					}
+				}
+			}
+
+			/**
+			 * Removes the block with the given index from all cells it overlaps.
+			 */
+			void Remove(const Block& block, std::uint32_t index)
+			{
+				int min_column, min_row, max_column, max_row;
+				CellRange(block.end_left, block.end_right, min_column, min_row, max_column, max_row);
+
+				for (int row = min_row; row <= max_row; ++row)
+				{
+					for (int column = min_column; column <= max_column; ++column)
+					{
+						auto& cell = cells[row * columns + column];
+						auto it = std::find(cell.begin(), cell.end(), index);
+						if (it != cell.end())
+						{
+							*it = cell.back();
+							cell.pop_back();
+						}
+					}
+				}
+			}
+
+			/**
+			 * Returns the number of blocks in the fullest cell.
+			 */
+			size_t MaxCellSize() const
+			{
+				size_t max_size = 0;
+				for (const auto& cell : cells)
+				{
+					max_size = std::max(max_size, cell.size());
+				}
+				return max_size;
+			}
+
+			/**
+			 * Calls the given function with the block indices of each cell overlapped by the given bounds until it returns true.
+			 * Blocks spanning several cells may be visited more than once.
+			 *
+			 * @param min Top left corner of the bounds.
+			 * @param max Bottom right corner of the bounds.
+			 * @param function Function taking a span of block indices and returning whether to stop.
+			 * @returns Whether the function returned true for a cell.
+			 */
+			template <typename Function>
+			bool ForEachCell(const Vector2D::Vector2D& min, const Vector2D::Vector2D& max, Function function) const
+			{
+				int min_column, min_row, max_column, max_row;
+				CellRange(min, max, min_column, min_row, max_column, max_row);
+
+				for (int row = min_row; row <= max_row; ++row)
+				{
+					for (int column = min_column; column <= max_column; ++column)
+					{
+						if (function(std::span<const std::uint32_t>(cells[row * columns + column])))
+						{
+							return true;
+						}
+					}
+				}
+
+				return false;
+			}
+
+		private:
+			void CellRange(const Vector2D::Vector2D& min, const Vector2D::Vector2D& max, int& min_column, int& min_row, int& max_column, int& max_row) const
+			{
+				min_column = std::clamp(static_cast<int>(std::floor(min.x / cell_size)), 0, columns - 1);
+				min_row = std::clamp(static_cast<int>(std::floor(min.y / cell_size)), 0, rows - 1);
+				max_column = std::clamp(static_cast<int>(std::floor(max.x / cell_size)), 0, columns - 1);
+				max_row = std::clamp(static_cast<int>(std::floor(max.y / cell_size)), 0, rows - 1);
+			}
+		};
+
+		/**
+		 * Game state describing structure.
+		 */
+		struct BlockBreakerGameState
+		{
+			/**
+			 * Position of the paddle.
+			 */
+			Vector2D::Vector2D paddle_position;
+			/**
+			 * Position of the ball.
+			 */
+			Vector2D::Vector2D ball_position;
+			/**
+			 * Position of the ball before the last step.
+			 */
+			Vector2D::Vector2D ball_position_prev;
+			/**
+			 * Direction vector for the ball trajectory.
+			 */
+			Vector2D::Vector2D ball_direction;
+			/**
+			 * Speed value equaling the magnitude of the ball_direction vector.
+			 */
+			float ball_speed = 10.f;
+
+			/**
+			 * Blocks to destroy.
+			 */
+			BlockSet blocks;
+			/**
+			 * Broadphase grid over the alive blocks. Updated whenever a block is destroyed.
+			 */
+			BlockGrid block_grid;
+			/**
+			 * Scratch list for the blocks of a cell whose bounds overlap the ball's swept bounds. Sized to the fullest cell.
+			 */
+			std::vector<std::uint32_t> overlap_candidates;
+			/**
+			 * Indices of the destroyed blocks in the order they were destroyed. Reserved for all blocks on reset,
+			 * so observers can catch up on the blocks destroyed since they last looked without scanning all blocks.
+			 */
+			std::vector<std::uint32_t> destroyed_blocks;
+
+			bool lost = false;
+			bool won = false;
+		};
+
+		/**
+		 * Enum listing the collision types.
+		 */
+		enum class CollisionTypes
+		{
+			Left,
+			TopLeft,
+			Top,
+			TopRight,
+			Right,
+			BottomRight,
+			Bottom,
+			BottomLeft,
+			None
+		};
+
+		/**
+		 * Transforms the given collision type into a printable string.
+		 *
+		 * @param c Collision type to transform into string.
+		 * @returns String for the collision type.
+		 */
+		inline const std::string ToString(CollisionTypes c)
+		{
+			switch (c)
+			{
+			case CollisionTypes::Left:			return "Left";
+			case CollisionTypes::TopLeft:		return "Top Left";
+			case CollisionTypes::TopRight:		return "Top Right";
+			case CollisionTypes::Right:			return "Right";
+			case CollisionTypes::BottomLeft:	return "Bottom Left";
+			case CollisionTypes::BottomRight:	return "Bottom Right";
+			case CollisionTypes::Top:			return "Top";
+			case CollisionTypes::Bottom:		return "Bottom";
+			case CollisionTypes::None:			return "None";
+			}
+			return "None";
+		}
+
+		/**
+		 * Creates a level consisting of rows of 5x2 blocks, starting in the top left corner of the board.
+		 * The default level consists of 3 rows with 12 blocks each.
+		 *
+		 * @param rows Number of block rows.
+		 * @param columns Number of blocks per row.
+		 * @returns Blocks of the level.
+		 */
+		std::vector<Block> CreateLevel(int rows = 3, int columns = 12);
+
+		/**
+		 * Headless Block Breaker physics simulation without any timing, UI or global state.
+		 * The ball is advanced by an explicitly given time step, so the same inputs always produce the same game.
+		 */
+		class BlockBreakerSimulation
+		{
+		public:
+			BlockBreakerSimulation(BlockBreakerConfig config = {});
+
+			/**
+			 * Resets the game state for a new start of the game with the default level.
+			 */
+			void Reset();
+
+			/**
+			 * Resets the game state for a new start of the game with the given level.
+			 *
+			 * @param level Blocks to destroy.
+			 */
+			void Reset(const std::vector<Block>& level);
+
+			/**
+			 * Moves the paddle by one step in the given direction as long as it stays within the board.
+			 *
+			 * @param input Direction to move the paddle in. Up, down and none are ignored.
+			 */
+			void MovePaddle(InputDirection input);
+
+			/**
+			 * Advances the ball by the given time step and handles all resulting collisions.
+			 *
+			 * @param dt Time step in seconds.
+			 */
+			void Step(double dt);
+
+			const BlockBreakerGameState& State() const
+			{
+				return state;
+			}
+
+			const BlockBreakerConfig& Config() const
+			{
+				return config;
+			}
+
+			bool IsOver() const
+			{
+				return state.lost || state.won;
+			}
+
+			/**
+			 * Returns the ball position between the positions before and after the last step, for drawing in between steps.
+			 *
+			 * @param alpha Fraction of a step that passed since the last step, between 0 and 1.
+			 */
+			Vector2D::Vector2D InterpolatedBallPosition(double alpha) const
+			{
+				return state.ball_position_prev + (state.ball_position - state.ball_position_prev) * alpha;
+			}
+
+		private:
+			BlockBreakerConfig config;
+			BlockBreakerGameState state;
+		};
+
+		/**
+		 * Object the ball can collide with.
+		 */
+		enum class ContactTarget
+		{
+			None,
+			Border,
+			Paddle,
+			Block
+		};
+
+		/**
+		 * First contact of the moving ball with an object.
+		 */
+		struct BallContact
+		{
+			/**
+			 * Fraction of the ball's displacement after which it touches the object, between 0 and 1.
+			 */
+			double time = 1.0;
+			ContactTarget target = ContactTarget::None;
+			/**
+			 * Type of collision from the ball's view. Decides how the ball is reflected.
+			 */
+			CollisionTypes type = CollisionTypes::None;
+			/**
+			 * Index of the touched block if the target is a block.
+			 */
+			std::uint32_t block = 0;
+
+			/**
+			 * Whether this contact happens before the given one. Contacts at the same time keep the earlier found one.
+			 */
+			bool IsBefore(const BallContact& other) const
+			{
+				return target != ContactTarget::None && (other.target == ContactTarget::None || time < other.time);
+			}
+		};
+
+		/**
+		 * Finds when the ball moving by the given displacement first reaches one of the game canvas's borders.
+		 *
+		 * @param config Configuration defining the board dimensions.
+		 * @param pos Position vector of the ball.
+		 * @param displacement Movement of the ball within the step.
+		 * @param ball_radius Radius of the ball.
+		 * @returns The contact with the border, if any.
+		 */
+		BallContact SweepBallAgainstBorder(const BlockBreakerConfig& config, const Vector2D::Vector2D& pos, const Vector2D::Vector2D& displacement, double ball_radius);
+
+		/**
+		 * Finds when the ball moving by the given displacement first lands on the top of the paddle controlled by the player.
+		 *
+		 * @param config Configuration defining the paddle dimensions.
+		 * @param game_state Current game state describing ball & paddle positions.
+		 * @param displacement Movement of the ball within the step.
+		 * @returns The contact with the paddle, if any. There is none if the ball already is below the paddle's top.
+		 */
+		BallContact SweepBallAgainstPaddle(const BlockBreakerConfig& config, const BlockBreakerGameState& game_state, const Vector2D::Vector2D& displacement);
+
+		/**
+		 * Finds when the ball moving by the given displacement first touches the given block.
+		 * Sweeps the ball's circle against the block, so it cannot pass through the block between two positions.
+		 *
+		 * @param b Block object to check.
+		 * @param pos Position vector of the ball.
+		 * @param displacement Movement of the ball within the step.
+		 * @param ball_radius Radius of the ball.
+		 * @returns The contact with the block, if any. The block index is not set.
+		 */
+		BallContact SweepBallAgainstBlock(const Block& b, const Vector2D::Vector2D& pos, const Vector2D::Vector2D& displacement, double ball_radius);
+
+		/**
+		 * Finds the first block the ball touches when moving by the given displacement.
+		 * Only tests the blocks in the broadphase cells overlapped by the ball's swept bounds.
+		 *
+		 * @param config Configuration defining the ball radius and the overlap kernel.
+		 * @param game_state Current game state.
+		 * @param displacement Movement of the ball within the step.
+		 * @returns The contact with the first touched block, if any.
+		 */
+		BallContact FindBlockContact(const BlockBreakerConfig& config, BlockBreakerGameState& game_state, const Vector2D::Vector2D& displacement);
+
+		/**
+		 * Handles the ball's collision with an object, i.e. applies direction changes.
+		 *
+		 * @param game_state Current state of the game.
+		 * @param collision_type Type of collision that has occurred.
+		 * @param collided_border Whether the ball collided with a border of the canvas.
+		 */
+		void HandleCollision(BlockBreakerGameState& game_state, CollisionTypes collision_type, bool collided_border);
+
+		/**
+		 * Handles the collision of the ball with the paddle.
+		 *
+		 * @param config Configuration defining the paddle dimensions and ball speed-up.
+		 * @param game_state Current game state.
+		 */
+		void HandlePaddleCollision(const BlockBreakerConfig& config, BlockBreakerGameState& game_state);
+
+		/**
+		 * Handles a contact of the ball placed at the contact point, i.e. reflects the ball and destroys a touched block.
+		 *
+		 * @param config Configuration of the game.
+		 * @param game_state Current game state.
+		 * @param contact Contact to handle.
+		 */
+		void HandleContact(const BlockBreakerConfig& config, BlockBreakerGameState& game_state, const BallContact& contact);
+	} // namespace BlockBreaker
+} // namespace TerminalMinigames
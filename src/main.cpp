@@ -1,9 +1,56 @@
 #include <stdlib.h> // for EXIT_SUCCESS
+#include <iostream>
+#include <string>
+#include <boost/program_options.hpp>
 #include "main_menu.cpp"
+#include "util/random.h"
 
-int main()
+int main(int argc, char* argv[])
 {
-    TerminalMinigames::StartGame();
+    namespace options = boost::program_options;
+
+    TerminalMinigames::ScreenOptions screen_options;
+    std::uint64_t seed = 0;
+    std::string replay_directory;
+
+    options::options_description description("Options");
+    description.add_options()
+        ("help", "Show this help")
+        ("diff-output", options::bool_switch(), "Only send the changed cells of each frame to the terminal")
+        ("max-fps", options::value<int>(&screen_options.max_fps)->default_value(screen_options.max_fps), "Maximum number of frames drawn per second")
+        ("frame-stats", options::bool_switch(&screen_options.show_frame_stats), "Show frame pacing and output statistics")
+        ("profile-output", options::value<std::string>(&screen_options.profile_output), "Write histograms of the profiled phases' durations to this file on exit")
+        ("seed", options::value<std::uint64_t>(&seed), "Seed of the first game, shown in the game, to play it again. Random by default")
+        ("record-replays", options::value<std::string>(&replay_directory), "Record a replay of every game into this directory, to play back with terminalMinigamesReplay");
+
+    options::variables_map arguments;
+    try
+    {
+        options::store(options::parse_command_line(argc, argv, description), arguments);
+        options::notify(arguments);
+    }
+    catch (const options::error& error)
+    {
+        std::cerr << error.what() << '\n' << description;
+        return EXIT_FAILURE;
+    }
+
+    if (arguments.count("help"))
+    {
+        std::cout << description;
+        return EXIT_SUCCESS;
+    }
+    if (arguments["diff-output"].as<bool>())
+    {
+        screen_options.backend = TerminalMinigames::OutputBackend::Diff;
+    }
+
+    if (!arguments.count("seed"))
+    {
+        seed = TerminalMinigames::RandomSeed();
+    }
+
+    TerminalMinigames::StartGame(screen_options, seed, replay_directory);
 
     return EXIT_SUCCESS;
-}
\ No newline at end of file
+}
@@ -1,29 +1,17 @@
+#include <iostream>
+
 #include "ftxui/component/screen_interactive.hpp" // for ScreenInteractive
 #include "ftxui/component/component.hpp"          // for Menu
 #include "ftxui/dom/elements.hpp"                 // for vbox, xflex, size
 
 #include "main_menu.h"
+#include "replay.h"
 #include "snake_game.h"
 #include "block_breaker.h"
 #include "util/util.h"
 
 namespace TerminalMinigames
 {
-    /**
-     * Flag whether the player quit the application.
-     */
-    bool quit = false;
-
-    /**
-     * Flag whether the player wants to return to the main menu.
-     */
-    bool back_to_menu = false;
-
-    /**
-     * Flag whether the player has started a game from the main menu.
-     */
-    bool game_started = false;
-
     /**
      * Index of the game selected from the list of available games.
      */
@@ -40,67 +28,73 @@ namespace TerminalMinigames
     std::vector<std::string> game_descriptions = { "Snake is a sub-genre of action video games where the player maneuvers the end of a growing line, often themed as a snake. The player must keep the snake from colliding with both other obstacles and itself, which gets harder as the snake lengthens. - Wikipedia",
     "In Block Breaker, you control a board at the bottom of the screen and must bounce the ball to destroy the blocks at the top of the screen with it. Note that the movement of the ball and collisions are restricted to the terminal window's characters so collisions might look like they might have to happen but they don't."};
 
-    /**
-     * Quit function to use to return to the main menu.
-     */
-    auto quit_game = [&] { back_to_menu = true; game_started = false; TerminalMinigames::StartGame(); };
+    namespace
+    {
+        /**
+         * Scene showing the game selection.
+         */
+        class MainMenuScene : public Scene
+        {
+        public:
+            MainMenuScene(std::function<void(int)> start_game)
+            {
+                auto component = ftxui::Container::Vertical({});
 
+                // Create dropdown
+                auto game_selection_dropdown = ftxui::Dropdown(&available_games, &selected_game);
+                component->Add(game_selection_dropdown);
 
-    void ExecuteMainMenu()
+                auto start_game_button = ftxui::Button(&start_button_label, [start_game] { start_game(selected_game); });
+                component->Add(start_game_button);
+
+                root = ftxui::Renderer(component, [=]
+                    { return ftxui::vbox({ ftxui::text("Terminal Minigames") | ftxui::bold | ftxui::center,
+                                            game_selection_dropdown->Render(),
+                                            ftxui::vbox({
+                                                ftxui::paragraph(game_descriptions[selected_game]),
+                                                ftxui::filler(),
+                                                start_game_button->Render()
+                                            }) | ftxui::center}); });
+            }
+
+            ftxui::Component Root() override
+            {
+                return root;
+            }
+
+        private:
+            std::string start_button_label = "Start";
+            ftxui::Component root;
+        };
+    }
+
+    std::unique_ptr<Scene> CreateMainMenuScene(std::function<void(int)> start_game)
     {
-        auto screen = ftxui::ScreenInteractive::Fullscreen();
-        auto component = ftxui::Container::Vertical({});
-
-        // Create dropdown
-        auto game_selection_dropdown = ftxui::Dropdown(&available_games, &selected_game);
-        component->Add(game_selection_dropdown);
-
-        std::string label = "Start";
-        auto start_game_button = ftxui::Button(&label, [&]
-                                               {
-                                                   game_started = true;
-                                                   back_to_menu = false;
-                                                   quit = false;
-                                                   screen.ExitLoopClosure()(); });
-        component->Add(start_game_button);
-
-        auto renderer = ftxui::Renderer(component, [&]
-            { return ftxui::vbox({ ftxui::text("Terminal Minigames") | ftxui::bold | ftxui::center,
-                                    game_selection_dropdown->Render(),
-                                    ftxui::vbox({
-                                        ftxui::paragraph(game_descriptions[selected_game]),
-                                        ftxui::filler(),
-                                        start_game_button->Render()
-                                    }) | ftxui::center}); });
-        screen.Loop(renderer);
+        return std::make_unique<MainMenuScene>(std::move(start_game));
     }
 
-    void StartGame()
+    void StartGame(const ScreenOptions& options, std::uint64_t seed, const std::string& replay_directory)
     {
-        while (!quit)
+        // Declared before the scenes, so it outlives the recordings they end when they are left
+        std::unique_ptr<ReplayRecorder> recorder;
+        if (!replay_directory.empty())
         {
-            if (!game_started)
-            {
-                ExecuteMainMenu();
-            }
-            else
-            {
-                switch (selected_game)
-                {
-                case 0:
-                    Snake::ExecuteSnake(quit_game, &back_to_menu);
-                    break;
-                case 1:
-                    BlockBreaker::ExecuteBlockBreaker(quit_game, &back_to_menu);
-                    break;
-                default:
-                {
-                    game_started = false;
-                    ExecuteMainMenu();
-                    break;
-                }
-                }
-            }
+            recorder = std::make_unique<ReplayRecorder>(replay_directory);
+        }
+
+        SceneManager scenes(options);
+        auto back_to_menu = [&scenes] { scenes.SwitchTo(0); };
+
+        // Scene 0 is the menu, the games follow in the order of the list of available games
+        scenes.Add(CreateMainMenuScene([&scenes](int game) { scenes.SwitchTo(game + 1); }));
+        scenes.Add(Snake::CreateSnakeScene(scenes.Scheduler(), back_to_menu, seed, recorder.get()));
+        scenes.Add(BlockBreaker::CreateBlockBreakerScene(scenes.Scheduler(), back_to_menu, recorder.get()));
+
+        scenes.Run(0);
+
+        if (recorder && !recorder->Close())
+        {
+            std::cerr << "Could not write all replays to " << replay_directory << '\n';
         }
     }
 
@@ -1,14 +1,27 @@
 #pragma once
 
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+
+#include "scene_manager.h"
+
 namespace TerminalMinigames
 {
     /**
-     * Starts the overall game by starting the main menu.
+     * Starts the overall game by showing the main menu. Returns once the screen is exited.
+     *
+     * @param options Settings of the screen.
+     * @param seed Seed of the first game of each game that uses randomness.
+     * @param replay_directory Directory to record a replay of every game into. No replays are recorded if empty.
      */
-	void StartGame();
+	void StartGame(const ScreenOptions& options, std::uint64_t seed, const std::string& replay_directory);
 
     /**
-     * Displays the main menu with the game selection.
+     * Creates the scene of the main menu with the game selection.
+     *
+     * @param start_game Function executed with the index of the selected game when the player presses the start button.
      */
-    void ExecuteMainMenu();
+    std::unique_ptr<Scene> CreateMainMenuScene(std::function<void(int)> start_game);
 }
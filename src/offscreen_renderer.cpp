@@ -0,0 +1,70 @@
+#include <chrono>
+#include <sstream>
+
+#include "offscreen_renderer.h"
+#include "util/profiler.h"
+
+namespace TerminalMinigames
+{
+    OffscreenRenderer::OffscreenRenderer(int width, int height)
+        : screen(width, height), discard_stream(&discard_buffer), writer(discard_stream)
+    {
+    }
+
+    const ftxui::Screen& OffscreenRenderer::Render(const ftxui::Element& element)
+    {
+        auto start = std::chrono::steady_clock::now();
+        {
+            ProfileScope profile(ProfilePhase::ScreenLayout);
+            screen.Clear();
+            ftxui::Render(screen, element);
+        }
+        render_seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        ++frames;
+
+        writer.Write(screen);
+        return screen;
+    }
+
+    std::string OffscreenRenderer::FrameText()
+    {
+        return screen.ToString();
+    }
+
+    double OffscreenRenderer::FramesPerSecond() const
+    {
+        return render_seconds > 0.0 ? static_cast<double>(frames) / render_seconds : 0.0;
+    }
+
+    GoldenComparison OffscreenRenderer::CompareWithGolden(std::istream& golden)
+    {
+        GoldenComparison comparison;
+
+        std::istringstream actual(FrameText());
+        std::string expected_line;
+        std::string actual_line;
+        for (int line = 0;; ++line)
+        {
+            bool has_expected = static_cast<bool>(std::getline(golden, expected_line));
+            bool has_actual = static_cast<bool>(std::getline(actual, actual_line));
+            if (!has_expected && !has_actual)
+            {
+                return comparison;
+            }
+
+            if (has_expected != has_actual || expected_line != actual_line)
+            {
+                comparison.matches = false;
+                comparison.first_different_line = line;
+                comparison.expected_line = has_expected ? expected_line : "";
+                comparison.actual_line = has_actual ? actual_line : "";
+                return comparison;
+            }
+        }
+    }
+
+    void OffscreenRenderer::WriteGolden(std::ostream& golden)
+    {
+        golden << FrameText() << '\n';
+    }
+}
@@ -0,0 +1,124 @@
+#pragma once
+
+#include <cstddef>
+#include <istream>
+#include <ostream>
+#include <streambuf>
+#include <string>
+
+#include "ftxui/dom/elements.hpp"
+#include "ftxui/screen/screen.hpp"
+
+#include "util/diff_frame_writer.h"
+
+namespace TerminalMinigames
+{
+    /**
+     * Outcome of comparing a frame with a golden frame.
+     */
+    struct GoldenComparison
+    {
+        bool matches = true;
+        /**
+         * First line that differs, counted from zero. Negative if the frames match.
+         */
+        int first_different_line = -1;
+        std::string expected_line;
+        std::string actual_line;
+    };
+
+    /**
+     * Renders elements into an in-memory screen instead of a terminal, e.g. to time the games' renderers or to compare
+     * their frames with golden frames where there is no TTY.
+     * Every frame is also passed through a DiffFrameWriter writing to nowhere, to count the bytes a terminal would receive.
+     */
+    class OffscreenRenderer
+    {
+    public:
+        /**
+         * @param width Width of the screen in text cells.
+         * @param height Height of the screen in text cells.
+         */
+        OffscreenRenderer(int width, int height);
+
+        OffscreenRenderer(const OffscreenRenderer&) = delete;
+        OffscreenRenderer& operator=(const OffscreenRenderer&) = delete;
+
+        /**
+         * Lays out and draws the given element into the screen, replacing the previous frame.
+         */
+        const ftxui::Screen& Render(const ftxui::Element& element);
+
+        const ftxui::Screen& Frame() const
+        {
+            return screen;
+        }
+
+        /**
+         * Whole frame as ftxui prints it, with the escape sequences of its colors and attributes.
+         */
+        std::string FrameText();
+
+        size_t Frames() const
+        {
+            return frames;
+        }
+
+        /**
+         * Frames rendered per second of time spent laying out and drawing them.
+         */
+        double FramesPerSecond() const;
+
+        /**
+         * Bytes sent for the last frame if only its changes were written to a terminal, and how many cells changed.
+         */
+        const FrameStats& LastFrameOutput() const
+        {
+            return writer.LastFrame();
+        }
+
+        /**
+         * Output statistics summed over all frames.
+         */
+        const FrameStats& OutputTotals() const
+        {
+            return writer.Totals();
+        }
+
+        /**
+         * Compares the current frame with a golden frame written by WriteGolden().
+         */
+        GoldenComparison CompareWithGolden(std::istream& golden);
+
+        /**
+         * Writes the current frame as golden frame to compare later frames with.
+         */
+        void WriteGolden(std::ostream& golden);
+
+    private:
+        /**
+         * Stream buffer that discards everything written to it.
+         */
+        class DiscardBuffer : public std::streambuf
+        {
+        protected:
+            int overflow(int character) override
+            {
+                return traits_type::not_eof(character);
+            }
+
+            std::streamsize xsputn(const char*, std::streamsize count) override
+            {
+                return count;
+            }
+        };
+
+        ftxui::Screen screen;
+        DiscardBuffer discard_buffer;
+        std::ostream discard_stream;
+        DiffFrameWriter writer;
+
+        size_t frames = 0;
+        double render_seconds = 0.0;
+    };
+}
@@ -0,0 +1,565 @@
+#include <bit>
+#include <chrono>
+#include <cmath>
+#include <format>
+#include <fstream>
+#include <istream>
+#include <iterator>
+#include <unordered_map>
+
+#include "replay.h"
+
+namespace TerminalMinigames
+{
+    namespace
+    {
+        constexpr char magic[] = { 'T', 'M', 'R', 'P' };
+        constexpr std::uint64_t format_version = 1;
+
+        /**
+         * Number of bits of a record holding its code, i.e. the input direction or kind of end.
+         */
+        constexpr int record_code_bits = 3;
+        constexpr std::uint64_t game_over_code = 6;
+        constexpr std::uint64_t stopped_code = 7;
+
+        /**
+         * Number of buffered bytes from which a recording hands its buffer to the writer thread.
+         */
+        constexpr size_t chunk_size = 4096;
+
+        std::uint64_t InputCode(InputDirection direction)
+        {
+            switch (direction)
+            {
+            case InputDirection::Left: return 0;
+            case InputDirection::Right: return 1;
+            case InputDirection::Up: return 2;
+            case InputDirection::Down: return 3;
+            default: return 4;
+            }
+        }
+
+        /**
+         * Appends the header fields to a byte buffer.
+         */
+        class HeaderWriter
+        {
+        public:
+            explicit HeaderWriter(std::vector<std::uint8_t>& bytes) : bytes(bytes)
+            {
+            }
+
+            void operator()(int value)
+            {
+                // Zigzag encoding keeps small negative numbers small
+                std::int64_t wide = value;
+                WriteVarint(bytes, (static_cast<std::uint64_t>(wide) << 1) ^ static_cast<std::uint64_t>(wide >> 63));
+            }
+
+            void operator()(double value)
+            {
+                WriteLittleEndian(std::bit_cast<std::uint64_t>(value), sizeof(value));
+            }
+
+            void operator()(float value)
+            {
+                WriteLittleEndian(std::bit_cast<std::uint32_t>(value), sizeof(value));
+            }
+
+        private:
+            void WriteLittleEndian(std::uint64_t bits, size_t size)
+            {
+                for (size_t index = 0; index < size; ++index)
+                {
+                    bytes.push_back(static_cast<std::uint8_t>(bits >> (8 * index)));
+                }
+            }
+
+            std::vector<std::uint8_t>& bytes;
+        };
+
+        /**
+         * Reads the header fields from a byte buffer. Reading past its end sets the fields to zero and fails the reader.
+         */
+        class HeaderReader
+        {
+        public:
+            HeaderReader(std::span<const std::uint8_t> bytes, size_t& offset) : bytes(bytes), offset(offset)
+            {
+            }
+
+            void operator()(int& value)
+            {
+                std::uint64_t encoded = 0;
+                ok = ok && ReadVarint(bytes, offset, encoded);
+                value = static_cast<int>(static_cast<std::int64_t>(encoded >> 1) ^ -static_cast<std::int64_t>(encoded & 1));
+            }
+
+            void operator()(double& value)
+            {
+                value = std::bit_cast<double>(ReadLittleEndian(sizeof(value)));
+            }
+
+            void operator()(float& value)
+            {
+                value = std::bit_cast<float>(static_cast<std::uint32_t>(ReadLittleEndian(sizeof(value))));
+            }
+
+            bool Ok() const
+            {
+                return ok;
+            }
+
+        private:
+            std::uint64_t ReadLittleEndian(size_t size)
+            {
+                if (!ok || bytes.size() - offset < size)
+                {
+                    ok = false;
+                    return 0;
+                }
+
+                std::uint64_t bits = 0;
+                for (size_t index = 0; index < size; ++index)
+                {
+                    bits |= static_cast<std::uint64_t>(bytes[offset++]) << (8 * index);
+                }
+                return bits;
+            }
+
+            std::span<const std::uint8_t> bytes;
+            size_t& offset;
+            bool ok = true;
+        };
+
+        /**
+         * Passes each stored field of the given configuration to the visitor, in the order of the file format.
+         */
+        template <typename Config, typename Visitor>
+        void VisitSnakeConfig(Config& config, Visitor& visit)
+        {
+            visit(config.movement_offset);
+            visit(config.board_dimension_x);
+            visit(config.board_dimension_y);
+            visit(config.min_x_dimension);
+            visit(config.min_y_dimension);
+            visit(config.max_x_dimension);
+            visit(config.max_y_dimension);
+            visit(config.grid_origin_x);
+            visit(config.grid_origin_y);
+            visit(config.start_x);
+            visit(config.start_y);
+            visit(config.start_length);
+            visit(config.food_spawn_interval_seconds);
+            visit(config.tick_rate_initial);
+            visit(config.tick_rate_increase_per_food);
+            visit(config.tick_rate_max);
+        }
+
+        template <typename Config, typename Visitor>
+        void VisitBlockBreakerConfig(Config& config, Visitor& visit)
+        {
+            visit(config.board_dimension_x);
+            visit(config.board_dimension_y);
+            visit(config.paddle_width);
+            visit(config.paddle_height);
+            visit(config.paddle_step_size);
+            visit(config.paddle_start_position.x);
+            visit(config.paddle_start_position.y);
+            visit(config.ball_speed_initial);
+            visit(config.ball_radius);
+            visit(config.speed_increase_factor);
+            visit(config.ball_speed_max);
+            visit(config.min_theta);
+            visit(config.broadphase_cell_size);
+            visit(config.max_collisions_per_step);
+        }
+
+        /**
+         * Upper bound of the cells of a grid the simulations allocate for a configuration read from a header, far above
+         * any board the games use, so a corrupt header cannot make them allocate gigabytes.
+         */
+        constexpr std::int64_t max_grid_cells = std::int64_t(1) << 24;
+        /**
+         * Upper bound of the canvas pixels of a board read from a header, for the same reason.
+         */
+        constexpr std::int64_t max_board_area = std::int64_t(1) << 28;
+
+        bool IsFinitePositive(double value)
+        {
+            return std::isfinite(value) && value > 0.0;
+        }
+
+        bool IsValidBoard(int width, int height)
+        {
+            return width > 0 && height > 0 && static_cast<std::int64_t>(width) * height <= max_board_area;
+        }
+
+        /**
+         * Checks whether a Snake game can be simulated with the given configuration read from a header.
+         */
+        bool IsValidSnakeConfig(const Snake::SnakeConfig& config)
+        {
+            if (config.movement_offset <= 0 || !IsValidBoard(config.board_dimension_x, config.board_dimension_y)
+                || config.max_x_dimension < config.min_x_dimension || config.max_y_dimension < config.min_y_dimension
+                || config.max_x_dimension < config.grid_origin_x || config.max_y_dimension < config.grid_origin_y)
+            {
+                return false;
+            }
+
+            // Computed like GridWidth() and GridHeight(), but wide enough for any values a header holds
+            std::int64_t width = (static_cast<std::int64_t>(config.max_x_dimension) - config.grid_origin_x) / config.movement_offset + 1;
+            std::int64_t height = (static_cast<std::int64_t>(config.max_y_dimension) - config.grid_origin_y) / config.movement_offset + 1;
+            if (width > max_grid_cells || height > max_grid_cells || width * height > max_grid_cells)
+            {
+                return false;
+            }
+
+            // The snake starts as a row of cells from its head to the right
+            if (config.start_length < 1 || config.start_x < 0 || config.start_y < 0
+                || static_cast<std::int64_t>(config.start_x) + config.start_length - 1 >= width || config.start_y >= height)
+            {
+                return false;
+            }
+
+            return IsFinitePositive(config.food_spawn_interval_seconds) && IsFinitePositive(config.tick_rate_initial)
+                && IsFinitePositive(config.tick_rate_max) && std::isfinite(config.tick_rate_increase_per_food)
+                && config.tick_rate_increase_per_food >= 0.0;
+        }
+
+        /**
+         * Checks whether a Block Breaker game can be simulated with the given configuration and step length read from a header.
+         */
+        bool IsValidBlockBreakerConfig(const BlockBreaker::BlockBreakerConfig& config, double step_seconds)
+        {
+            if (!IsValidBoard(config.board_dimension_x, config.board_dimension_y) || config.paddle_width <= 0
+                || config.paddle_step_size <= 0 || config.max_collisions_per_step <= 0)
+            {
+                return false;
+            }
+
+            if (!IsFinitePositive(step_seconds) || !IsFinitePositive(config.broadphase_cell_size)
+                || !IsFinitePositive(config.ball_speed_initial) || !IsFinitePositive(config.ball_speed_max)
+                || !IsFinitePositive(config.ball_radius))
+            {
+                return false;
+            }
+
+            // Size of the broadphase grid BlockGrid::Build() allocates
+            double columns = std::ceil(config.board_dimension_x / config.broadphase_cell_size) + 1;
+            double rows = std::ceil(config.board_dimension_y / config.broadphase_cell_size) + 1;
+            if (columns * rows > max_grid_cells)
+            {
+                return false;
+            }
+
+            const Vector2D::Vector2D& paddle = config.paddle_start_position;
+            return paddle.x >= 0.0 && paddle.x <= config.board_dimension_x && paddle.y >= 0.0 && paddle.y <= config.board_dimension_y;
+        }
+    }
+
+    void WriteVarint(std::vector<std::uint8_t>& bytes, std::uint64_t value)
+    {
+        while (value >= 0x80)
+        {
+            bytes.push_back(static_cast<std::uint8_t>(value | 0x80));
+            value >>= 7;
+        }
+        bytes.push_back(static_cast<std::uint8_t>(value));
+    }
+
+    bool ReadVarint(std::span<const std::uint8_t> bytes, size_t& offset, std::uint64_t& value)
+    {
+        value = 0;
+        for (size_t index = offset, shift = 0; index < bytes.size() && shift < 64; ++index, shift += 7)
+        {
+            value |= static_cast<std::uint64_t>(bytes[index] & 0x7f) << shift;
+            if (!(bytes[index] & 0x80))
+            {
+                offset = index + 1;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void WriteReplayHeader(std::vector<std::uint8_t>& bytes, const Replay& replay)
+    {
+        bytes.insert(bytes.end(), std::begin(magic), std::end(magic));
+        WriteVarint(bytes, format_version);
+        bytes.push_back(static_cast<std::uint8_t>(replay.game));
+
+        HeaderWriter writer(bytes);
+        if (replay.game == ReplayGame::Snake)
+        {
+            WriteVarint(bytes, replay.seed);
+            VisitSnakeConfig(replay.snake_config, writer);
+        }
+        else
+        {
+            VisitBlockBreakerConfig(replay.block_breaker_config, writer);
+            writer(replay.step_seconds);
+        }
+    }
+
+    bool ReadReplay(std::istream& input, Replay& replay, std::string& error)
+    {
+        std::vector<std::uint8_t> bytes((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+        replay = {};
+
+        std::uint64_t version = 0;
+        size_t offset = sizeof(magic);
+        if (bytes.size() < sizeof(magic) || !std::equal(std::begin(magic), std::end(magic), bytes.begin()))
+        {
+            error = "not a replay file";
+            return false;
+        }
+        if (!ReadVarint(bytes, offset, version) || version != format_version)
+        {
+            error = std::format("unsupported replay format version {}", version);
+            return false;
+        }
+        if (offset == bytes.size())
+        {
+            error = "the header is incomplete";
+            return false;
+        }
+
+        replay.game = static_cast<ReplayGame>(bytes[offset++]);
+        HeaderReader reader(bytes, offset);
+        if (replay.game == ReplayGame::Snake)
+        {
+            if (!ReadVarint(bytes, offset, replay.seed))
+            {
+                error = "the header is incomplete";
+                return false;
+            }
+            VisitSnakeConfig(replay.snake_config, reader);
+        }
+        else if (replay.game == ReplayGame::BlockBreaker)
+        {
+            VisitBlockBreakerConfig(replay.block_breaker_config, reader);
+            reader(replay.step_seconds);
+        }
+        else
+        {
+            error = std::format("unknown game {}", static_cast<int>(replay.game));
+            return false;
+        }
+        if (!reader.Ok())
+        {
+            error = "the header is incomplete";
+            return false;
+        }
+        bool valid = replay.game == ReplayGame::Snake ? IsValidSnakeConfig(replay.snake_config)
+            : IsValidBlockBreakerConfig(replay.block_breaker_config, replay.step_seconds);
+        if (!valid)
+        {
+            error = "the header holds an invalid configuration";
+            return false;
+        }
+
+        std::uint64_t record = 0;
+        std::uint64_t tick = 0;
+        while (ReadVarint(bytes, offset, record))
+        {
+            tick += record >> record_code_bits;
+            std::uint64_t code = record & ((1 << record_code_bits) - 1);
+            if (code == game_over_code || code == stopped_code)
+            {
+                replay.end = code == game_over_code ? ReplayEnd::GameOver : ReplayEnd::Stopped;
+                break;
+            }
+            if (code > InputCode(InputDirection::Down))
+            {
+                // A corrupt record; keep the inputs up to it
+                break;
+            }
+            replay.inputs.push_back({ tick, static_cast<InputDirection>(code) });
+        }
+        replay.end_tick = tick;
+        return true;
+    }
+
+    ReplayRecording::ReplayRecording(ReplayRecorder* recorder, std::uint64_t file, std::filesystem::path path, std::vector<std::uint8_t> header)
+        : recorder(recorder), file(file), path(std::move(path)), buffer(std::move(header))
+    {
+    }
+
+    ReplayRecording::ReplayRecording(ReplayRecording&& other) noexcept
+        : recorder(std::exchange(other.recorder, nullptr)), file(other.file), path(std::move(other.path)), buffer(std::move(other.buffer)),
+        tick(other.tick), last_record_tick(other.last_record_tick)
+    {
+    }
+
+    ReplayRecording& ReplayRecording::operator=(ReplayRecording&& other) noexcept
+    {
+        if (this != &other)
+        {
+            End(ReplayEnd::Stopped);
+            recorder = std::exchange(other.recorder, nullptr);
+            file = other.file;
+            path = std::move(other.path);
+            buffer = std::move(other.buffer);
+            tick = other.tick;
+            last_record_tick = other.last_record_tick;
+        }
+        return *this;
+    }
+
+    ReplayRecording::~ReplayRecording()
+    {
+        End(ReplayEnd::Stopped);
+    }
+
+    void ReplayRecording::Input(InputDirection direction)
+    {
+        if (recorder && direction != InputDirection::None)
+        {
+            AppendRecord(InputCode(direction));
+        }
+    }
+
+    void ReplayRecording::GameOver()
+    {
+        End(ReplayEnd::GameOver);
+    }
+
+    void ReplayRecording::AppendRecord(std::uint64_t code)
+    {
+        WriteVarint(buffer, ((tick - last_record_tick) << record_code_bits) | code);
+        last_record_tick = tick;
+        if (buffer.size() >= chunk_size)
+        {
+            Submit(false);
+        }
+    }
+
+    void ReplayRecording::End(ReplayEnd end)
+    {
+        if (!recorder)
+        {
+            return;
+        }
+
+        AppendRecord(end == ReplayEnd::GameOver ? game_over_code : stopped_code);
+        Submit(true);
+        recorder = nullptr;
+    }
+
+    void ReplayRecording::Submit(bool last)
+    {
+        ReplayRecorder::Chunk chunk;
+        chunk.file = file;
+        chunk.path = path;
+        chunk.bytes = std::move(buffer);
+        chunk.last = last;
+        recorder->Submit(std::move(chunk));
+
+        buffer.clear();
+        buffer.reserve(chunk_size + 16);
+    }
+
+    ReplayRecorder::ReplayRecorder(std::filesystem::path directory) : directory(std::move(directory))
+    {
+        writer_thread = std::jthread([this](std::stop_token stop) { RunWriter(stop); });
+    }
+
+    ReplayRecorder::~ReplayRecorder()
+    {
+        Close();
+    }
+
+    ReplayRecording ReplayRecorder::Record(const Replay& header)
+    {
+        std::vector<std::uint8_t> bytes;
+        bytes.reserve(chunk_size + 16);
+        WriteReplayHeader(bytes, header);
+
+        auto seconds = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+        std::string name = std::format("{}-{}-{}.tmreplay", header.game == ReplayGame::Snake ? "snake" : "block_breaker", seconds, ++last_file);
+        return ReplayRecording(this, last_file, directory / name, std::move(bytes));
+    }
+
+    bool ReplayRecorder::Close()
+    {
+        writer_thread.request_stop();
+        if (writer_thread.joinable())
+        {
+            writer_thread.join();
+        }
+        return !failed;
+    }
+
+    void ReplayRecorder::Submit(Chunk chunk)
+    {
+        {
+            std::lock_guard lock(mutex);
+            pending.push_back(std::move(chunk));
+        }
+        condition.notify_one();
+    }
+
+    void ReplayRecorder::RunWriter(std::stop_token stop)
+    {
+        std::unordered_map<std::uint64_t, std::ofstream> files;
+        std::error_code directory_error;
+        std::filesystem::create_directories(directory, directory_error);
+
+        std::unique_lock lock(mutex);
+        while (condition.wait(lock, stop, [this] { return !pending.empty(); }))
+        {
+            std::vector<Chunk> chunks = std::exchange(pending, {});
+            lock.unlock();
+
+            bool written = true;
+            for (Chunk& chunk : chunks)
+            {
+                auto [entry, created] = files.try_emplace(chunk.file);
+                std::ofstream& output = entry->second;
+                if (created)
+                {
+                    output.open(chunk.path, std::ios::binary);
+                }
+
+                output.write(reinterpret_cast<const char*>(chunk.bytes.data()), static_cast<std::streamsize>(chunk.bytes.size()));
+                // Flushed right away, so a file can be read up to its latest chunk while the game is still running
+                output.flush();
+                written = written && static_cast<bool>(output);
+                if (chunk.last)
+                {
+                    files.erase(entry);
+                }
+            }
+
+            lock.lock();
+            failed = failed || !written;
+        }
+    }
+
+    SnakeReplayPlayer::SnakeReplayPlayer(Replay replay, std::uint64_t keyframe_interval)
+        : ReplayPlayer(replay, Snake::SnakeSimulation(replay.snake_config, replay.seed), keyframe_interval)
+    {
+    }
+
+    void SnakeReplayPlayer::SimulateTick(Snake::SnakeSimulation& simulation, std::span<const ReplayInput> inputs)
+    {
+        // The game applies at most one turn per tick
+        simulation.Step(inputs.empty() ? InputDirection::None : inputs.front().direction);
+    }
+
+    BlockBreakerReplayPlayer::BlockBreakerReplayPlayer(Replay replay, std::uint64_t keyframe_interval)
+        : ReplayPlayer(replay, BlockBreaker::BlockBreakerSimulation(replay.block_breaker_config), keyframe_interval)
+    {
+    }
+
+    void BlockBreakerReplayPlayer::SimulateTick(BlockBreaker::BlockBreakerSimulation& simulation, std::span<const ReplayInput> inputs)
+    {
+        for (const ReplayInput& input : inputs)
+        {
+            simulation.MovePaddle(input.direction);
+        }
+        simulation.Step(Recording().step_seconds);
+    }
+}
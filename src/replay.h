@@ -0,0 +1,403 @@
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <iosfwd>
+#include <mutex>
+#include <span>
+#include <stop_token>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "block_breaker_simulation.h"
+#include "snake_simulation.h"
+#include "util/input_direction.h"
+
+namespace TerminalMinigames
+{
+    /**
+     * Game a replay was recorded from.
+     */
+    enum class ReplayGame : std::uint8_t
+    {
+        Snake = 1,
+        BlockBreaker = 2
+    };
+
+    /**
+     * How the recording of a replay ended.
+     */
+    enum class ReplayEnd
+    {
+        /**
+         * The game ended at the end tick.
+         */
+        GameOver,
+        /**
+         * The game was restarted or left at the end tick.
+         */
+        Stopped,
+        /**
+         * The file ends without an end record, e.g. because the application was killed. The end tick is the tick of
+         * the last input.
+         */
+        Truncated
+    };
+
+    /**
+     * Input applied to the simulation right before the given tick, i.e. after that many ticks were simulated.
+     */
+    struct ReplayInput
+    {
+        std::uint64_t tick = 0;
+        InputDirection direction = InputDirection::None;
+    };
+
+    /**
+     * Everything needed to simulate a recorded game again: the game's configuration and seed and the inputs in order.
+     * The simulations are deterministic, so the same inputs at the same ticks always produce the same game.
+     *
+     * A replay file starts with the header: the magic "TMRP", a varint format version, the game as one byte, then the
+     * game's seed and configuration. The Block Breaker overlap kernel is not stored: all kernels find the same blocks,
+     * so playback uses the best one the CPU supports. Integers are varints, signed ones zigzag encoded, and floating
+     * point numbers are stored as their little-endian bits. Each record that follows is a single varint holding the
+     * number of ticks since the previous record shifted left by three bits, with the input direction or the kind of end
+     * in the low bits. Most inputs thus take one byte, and a file can be read up to its last complete record at any time.
+     */
+    struct Replay
+    {
+        ReplayGame game = ReplayGame::Snake;
+        /**
+         * Seed of the Snake game. Block Breaker has no randomness.
+         */
+        std::uint64_t seed = 0;
+        Snake::SnakeConfig snake_config;
+        BlockBreaker::BlockBreakerConfig block_breaker_config;
+        /**
+         * Length of a Block Breaker physics step in seconds, i.e. of one tick.
+         */
+        double step_seconds = 0.0;
+
+        std::vector<ReplayInput> inputs;
+        std::uint64_t end_tick = 0;
+        ReplayEnd end = ReplayEnd::Truncated;
+    };
+
+    /**
+     * Appends the given number as a varint: seven bits per byte, least significant first, with the high bit set on
+     * all bytes but the last.
+     */
+    void WriteVarint(std::vector<std::uint8_t>& bytes, std::uint64_t value);
+
+    /**
+     * Reads a varint starting at the given offset and moves the offset past it.
+     *
+     * @returns Whether a complete varint was read.
+     */
+    bool ReadVarint(std::span<const std::uint8_t> bytes, size_t& offset, std::uint64_t& value);
+
+    /**
+     * Appends the header of the given replay, i.e. everything but its inputs and end.
+     */
+    void WriteReplayHeader(std::vector<std::uint8_t>& bytes, const Replay& replay);
+
+    /**
+     * Reads a replay file, accepting files whose recording was cut off after any complete record.
+     *
+     * @param input Stream to read the file from.
+     * @param replay Set to the replay read.
+     * @param error Set to the reason the file could not be read.
+     * @returns Whether the header could be read and holds a configuration the game can be simulated with.
+     */
+    bool ReadReplay(std::istream& input, Replay& replay, std::string& error);
+
+    class ReplayRecorder;
+
+    /**
+     * Records the inputs of a single game into a replay file. Recording only appends to an in-memory buffer, so it is
+     * cheap enough to do on every tick; full buffers are written to the file by the recorder's writer thread.
+     * The recording ends when the game is over or when it is destroyed or replaced, which marks the game as stopped.
+     * A default constructed recording records nothing.
+     */
+    class ReplayRecording
+    {
+    public:
+        ReplayRecording() = default;
+        ReplayRecording(ReplayRecording&& other) noexcept;
+        ReplayRecording& operator=(ReplayRecording&& other) noexcept;
+        ~ReplayRecording();
+
+        /**
+         * Records an input applied before the next tick.
+         */
+        void Input(InputDirection direction);
+
+        /**
+         * Counts a simulated tick.
+         */
+        void Tick()
+        {
+            ++tick;
+        }
+
+        /**
+         * Ends the recording with the game being over after the ticks counted so far.
+         */
+        void GameOver();
+
+    private:
+        friend class ReplayRecorder;
+
+        ReplayRecording(ReplayRecorder* recorder, std::uint64_t file, std::filesystem::path path, std::vector<std::uint8_t> header);
+
+        void AppendRecord(std::uint64_t code);
+        void End(ReplayEnd end);
+        /**
+         * Hands the buffered bytes to the writer thread.
+         */
+        void Submit(bool last);
+
+        ReplayRecorder* recorder = nullptr;
+        std::uint64_t file = 0;
+        std::filesystem::path path;
+        std::vector<std::uint8_t> buffer;
+        std::uint64_t tick = 0;
+        std::uint64_t last_record_tick = 0;
+    };
+
+    /**
+     * Creates a replay file for every recorded game in a directory and writes the recordings' bytes on its own thread,
+     * so the games never wait for the disk.
+     */
+    class ReplayRecorder
+    {
+    public:
+        /**
+         * @param directory Directory to create the replay files in. Created if it does not exist.
+         */
+        explicit ReplayRecorder(std::filesystem::path directory);
+        /**
+         * Writes everything submitted so far and stops the writer thread.
+         */
+        ~ReplayRecorder();
+
+        ReplayRecorder(const ReplayRecorder&) = delete;
+        ReplayRecorder& operator=(const ReplayRecorder&) = delete;
+
+        /**
+         * Starts recording a game into a new file named after the game, the time and the number of the recording.
+         *
+         * @param header Game, seed and configuration of the game to record. Its inputs and end are ignored.
+         */
+        ReplayRecording Record(const Replay& header);
+
+        /**
+         * Writes everything submitted so far and stops the writer thread. Recordings must not be used afterwards.
+         *
+         * @returns Whether all replay files were written.
+         */
+        bool Close();
+
+        const std::filesystem::path& Directory() const
+        {
+            return directory;
+        }
+
+    private:
+        friend class ReplayRecording;
+
+        /**
+         * Bytes to append to a replay file.
+         */
+        struct Chunk
+        {
+            std::uint64_t file = 0;
+            /**
+             * Path of the file, which is created by its first chunk.
+             */
+            std::filesystem::path path;
+            std::vector<std::uint8_t> bytes;
+            /**
+             * Whether the file is complete and can be closed.
+             */
+            bool last = false;
+        };
+
+        void Submit(Chunk chunk);
+        void RunWriter(std::stop_token stop);
+
+        std::filesystem::path directory;
+        std::uint64_t last_file = 0;
+
+        std::mutex mutex;
+        std::condition_variable_any condition;
+        std::vector<Chunk> pending;
+        bool failed = false;
+        std::jthread writer_thread;
+    };
+
+    /**
+     * Plays a replay back by simulating it again, tick by tick, as fast as it is stepped.
+     * Copies of the simulation are kept as keyframes at a fixed tick interval as the replay is played, so seeking back
+     * restores the closest keyframe and only simulates the ticks from there.
+     *
+     * @tparam Simulation Type of the simulation, which must be copyable.
+     */
+    template <typename Simulation>
+    class ReplayPlayer
+    {
+    public:
+        virtual ~ReplayPlayer() = default;
+
+        const Replay& Recording() const
+        {
+            return replay;
+        }
+
+        const Simulation& State() const
+        {
+            return simulation;
+        }
+
+        /**
+         * Number of ticks simulated.
+         */
+        std::uint64_t Tick() const
+        {
+            return tick;
+        }
+
+        bool AtEnd() const
+        {
+            return tick >= replay.end_tick;
+        }
+
+        size_t Keyframes() const
+        {
+            return keyframes.size();
+        }
+
+        /**
+         * Simulates the next tick with the inputs recorded for it. Does nothing at the end of the replay.
+         */
+        void Step()
+        {
+            if (AtEnd())
+            {
+                return;
+            }
+
+            size_t first_input = next_input;
+            while (next_input < replay.inputs.size() && replay.inputs[next_input].tick == tick)
+            {
+                ++next_input;
+            }
+            SimulateTick(simulation, std::span(replay.inputs).subspan(first_input, next_input - first_input));
+            ++tick;
+
+            if (tick % keyframe_interval == 0 && keyframes.back().tick < tick)
+            {
+                keyframes.push_back({ tick, next_input, simulation });
+            }
+        }
+
+        /**
+         * Moves playback to the given tick, or to the end if the replay is shorter.
+         */
+        void SeekTo(std::uint64_t target)
+        {
+            target = std::min(target, replay.end_tick);
+
+            // Keyframes are only stored up to the furthest tick played so far, so the closest one may be behind
+            // the current tick even when seeking forward
+            auto keyframe = std::prev(std::upper_bound(keyframes.begin(), keyframes.end(), target,
+                [](std::uint64_t target, const Keyframe& keyframe) { return target < keyframe.tick; }));
+            if (target < tick || keyframe->tick > tick)
+            {
+                tick = keyframe->tick;
+                next_input = keyframe->next_input;
+                simulation = keyframe->simulation;
+            }
+
+            while (tick < target)
+            {
+                Step();
+            }
+        }
+
+    protected:
+        /**
+         * @param replay Replay to play.
+         * @param start Simulation in the state at the start of the recorded game.
+         * @param keyframe_interval Number of ticks between two keyframes.
+         */
+        ReplayPlayer(Replay replay, Simulation start, std::uint64_t keyframe_interval)
+            : replay(std::move(replay)), simulation(std::move(start)), keyframe_interval(std::max<std::uint64_t>(keyframe_interval, 1))
+        {
+            keyframes.push_back({ 0, 0, simulation });
+        }
+
+        /**
+         * Simulates a tick of the game after applying the given inputs.
+         */
+        virtual void SimulateTick(Simulation& simulation, std::span<const ReplayInput> inputs) = 0;
+
+    private:
+        struct Keyframe
+        {
+            std::uint64_t tick = 0;
+            size_t next_input = 0;
+            Simulation simulation;
+        };
+
+        Replay replay;
+        Simulation simulation;
+        std::uint64_t tick = 0;
+        /**
+         * Index of the first input not applied yet.
+         */
+        size_t next_input = 0;
+
+        std::uint64_t keyframe_interval;
+        /**
+         * Keyframes by ascending tick, starting with the start of the game.
+         */
+        std::vector<Keyframe> keyframes;
+    };
+
+    /**
+     * Plays back a Snake replay, one tick per simulation step.
+     */
+    class SnakeReplayPlayer : public ReplayPlayer<Snake::SnakeSimulation>
+    {
+    public:
+        /**
+         * @param replay Snake replay to play.
+         * @param keyframe_interval Number of ticks between two keyframes.
+         */
+        explicit SnakeReplayPlayer(Replay replay, std::uint64_t keyframe_interval = 256);
+
+    protected:
+        void SimulateTick(Snake::SnakeSimulation& simulation, std::span<const ReplayInput> inputs) override;
+    };
+
+    /**
+     * Plays back a Block Breaker replay, one tick per physics step.
+     */
+    class BlockBreakerReplayPlayer : public ReplayPlayer<BlockBreaker::BlockBreakerSimulation>
+    {
+    public:
+        /**
+         * @param replay Block Breaker replay to play.
+         * @param keyframe_interval Number of ticks between two keyframes, by default ten seconds of physics steps.
+         */
+        explicit BlockBreakerReplayPlayer(Replay replay, std::uint64_t keyframe_interval = 2400);
+
+    protected:
+        void SimulateTick(BlockBreaker::BlockBreakerSimulation& simulation, std::span<const ReplayInput> inputs) override;
+    };
+}
@@ -0,0 +1,204 @@
+#include <format>
+#include <fstream>
+#include <iostream>
+
+#include "ftxui/component/event.hpp"
+#include "ftxui/dom/elements.hpp"
+
+#include "scene_manager.h"
+#include "util/profiler.h"
+
+namespace TerminalMinigames
+{
+    SceneManager::SceneManager(const ScreenOptions& options)
+        : screen(ftxui::ScreenInteractive::Fullscreen()),
+          frame_pacer(options.max_fps, [this] { PostFrame(); }),
+          scheduler([this] { WakeLoop(); }),
+          show_frame_stats(options.show_frame_stats),
+          profile_output(options.profile_output)
+    {
+        if (options.backend == OutputBackend::Diff && TerminalScreen::IsSupported())
+        {
+            terminal_screen = std::make_unique<TerminalScreen>(std::cout);
+        }
+    }
+
+    void SceneManager::RequestRedraw()
+    {
+        frame_pacer.RequestFrame();
+    }
+
+    void SceneManager::PostFrame()
+    {
+        if (terminal_screen)
+        {
+            terminal_screen->PostEvent(ftxui::Event::Custom);
+        }
+        else
+        {
+            screen.PostEvent(ftxui::Event::Custom);
+        }
+    }
+
+    void SceneManager::WakeLoop()
+    {
+        if (terminal_screen)
+        {
+            terminal_screen->PostEvent(task_wake_event);
+        }
+        else
+        {
+            screen.PostEvent(task_wake_event);
+        }
+    }
+
+    int SceneManager::Add(std::unique_ptr<Scene> scene)
+    {
+        scenes.push_back(std::move(scene));
+        return static_cast<int>(scenes.size()) - 1;
+    }
+
+    void SceneManager::SwitchTo(int index)
+    {
+        if (index == active_scene)
+        {
+            return;
+        }
+
+        scenes[active_scene]->Leave();
+        active_scene = index;
+        scenes[active_scene]->Enter();
+    }
+
+    void SceneManager::Run(int first_scene)
+    {
+        ftxui::Components roots;
+        for (const auto& scene : scenes)
+        {
+            roots.push_back(scene->Root());
+        }
+
+        scheduler.Start();
+        active_scene = first_scene;
+        scenes[active_scene]->Enter();
+
+        auto tabs = ftxui::Container::Tab(std::move(roots), &active_scene);
+        auto renderer = ftxui::Renderer(tabs, [this, tabs]
+            {
+                ftxui::Element scene;
+                {
+                    ProfileScope profile(ProfilePhase::SceneRender);
+                    scene = tabs->Render();
+                }
+                frame_pacer.FrameDrawn();
+
+                if (Profiler::Instance().IsEnabled())
+                {
+                    Profiler::Instance().Collect();
+                }
+                if (show_profile_overlay)
+                {
+                    scene = ftxui::hbox({ scene | ftxui::flex, ProfileOverlay() });
+                }
+                if (show_frame_stats)
+                {
+                    scene = ftxui::vbox({ scene | ftxui::flex, FrameStatsLine() | ftxui::dim });
+                }
+                return scene;
+            });
+        auto root = ftxui::CatchEvent(renderer, [this](ftxui::Event event)
+            {
+                // Every event is followed by a frame, so tasks whose timers expired run right before it is drawn
+                scheduler.RunDue();
+                if (event == task_wake_event)
+                {
+                    // The tasks ran as soon as their timers expired, only the frame showing them is paced
+                    RequestRedraw();
+                    return true;
+                }
+
+                if (event == ftxui::Event::Character('p') || event == ftxui::Event::Character('P'))
+                {
+                    show_profile_overlay = !show_profile_overlay;
+                    UpdateProfiling();
+                    return true;
+                }
+                return false;
+            });
+
+        UpdateProfiling();
+        frame_pacer.Start();
+        if (terminal_screen)
+        {
+            terminal_screen->Loop(root);
+        }
+        else
+        {
+            screen.Loop(root);
+        }
+        frame_pacer.Stop();
+
+        scenes[active_scene]->Leave();
+        scheduler.Stop();
+
+        if (!profile_output.empty())
+        {
+            WriteProfile();
+        }
+    }
+
+    void SceneManager::UpdateProfiling()
+    {
+        Profiler::Instance().SetEnabled(show_profile_overlay || !profile_output.empty());
+    }
+
+    ftxui::Element SceneManager::ProfileOverlay() const
+    {
+        const Profiler& profiler = Profiler::Instance();
+
+        ftxui::Elements lines;
+        lines.push_back(ftxui::text(std::format("{:<16}{:>9}{:>9}{:>9}", "Phase (ms)", "p50", "p99", "max")) | ftxui::bold);
+        for (size_t phase = 0; phase < profile_phase_count; ++phase)
+        {
+            const DurationHistogram& histogram = profiler.Histogram(static_cast<ProfilePhase>(phase));
+            lines.push_back(ftxui::text(std::format("{:<16}{:>9.3f}{:>9.3f}{:>9.3f}",
+                ToString(static_cast<ProfilePhase>(phase)),
+                histogram.Percentile(0.5) / 1e6, histogram.Percentile(0.99) / 1e6, histogram.Max() / 1e6)));
+        }
+        lines.push_back(ftxui::text(std::format("Dropped samples: {}", profiler.DroppedSamples())) | ftxui::dim);
+
+        return ftxui::window(ftxui::text("Profile"), ftxui::vbox(std::move(lines)));
+    }
+
+    void SceneManager::WriteProfile() const
+    {
+        Profiler& profiler = Profiler::Instance();
+        profiler.Collect();
+
+        std::ofstream file(profile_output);
+        if (!file)
+        {
+            std::cerr << "Could not write the profile to " << profile_output << '\n';
+            return;
+        }
+        profiler.WriteHistograms(file);
+    }
+
+    ftxui::Element SceneManager::FrameStatsLine() const
+    {
+        FramePacerStats pacing = frame_pacer.Stats();
+        std::string line = "Frames: " + std::to_string(pacing.frames_posted) + " posted, "
+            + std::to_string(pacing.requests_coalesced) + " coalesced, "
+            + std::to_string(pacing.frames_dropped) + " dropped";
+
+        // Output statistics of the previous frame, this one is not written yet
+        if (terminal_screen)
+        {
+            const FrameStats& last_frame = terminal_screen->Writer().LastFrame();
+            line += " | Last frame: " + std::to_string(last_frame.bytes_written) + " bytes, "
+                + std::to_string(last_frame.cells_changed) + " cells, "
+                + std::to_string(last_frame.flush_ms) + " ms";
+        }
+        return ftxui::text(line);
+    }
+}
@@ -0,0 +1,159 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "ftxui/component/component.hpp"
+#include "ftxui/component/event.hpp"
+#include "ftxui/component/screen_interactive.hpp"
+
+#include "terminal_screen.h"
+#include "util/coroutine_scheduler.h"
+#include "util/frame_pacer.h"
+
+namespace TerminalMinigames
+{
+    /**
+     * A screen of the application, e.g. the main menu or a game.
+     */
+    class Scene
+    {
+    public:
+        virtual ~Scene() = default;
+
+        /**
+         * Root component of the scene. Built once and kept while the scene is inactive.
+         */
+        virtual ftxui::Component Root() = 0;
+
+        /**
+         * Called when the scene becomes the active one, e.g. to start a game.
+         */
+        virtual void Enter() {}
+
+        /**
+         * Called when the scene stops being the active one, e.g. to cancel a game's tasks.
+         */
+        virtual void Leave() {}
+    };
+
+    /**
+     * How frames are sent to the terminal.
+     */
+    enum class OutputBackend
+    {
+        /**
+         * ftxui's ScreenInteractive, which sends the whole screen for every frame.
+         */
+        Ftxui,
+        /**
+         * TerminalScreen, which only sends the cells that changed. Falls back to Ftxui where it is not supported.
+         */
+        Diff
+    };
+
+    /**
+     * Settings of the screen the scenes are shown on.
+     */
+    struct ScreenOptions
+    {
+        OutputBackend backend = OutputBackend::Ftxui;
+        /**
+         * Maximum number of frames drawn per second for redraws requested by the games.
+         */
+        int max_fps = 60;
+        /**
+         * Whether to show a status line with the frame pacing and output statistics below the scenes.
+         */
+        bool show_frame_stats = false;
+        /**
+         * File to write the profiled phases' duration histograms to on exit. Profiling stays off unless this is set or
+         * the profile overlay is shown.
+         */
+        std::string profile_output;
+    };
+
+    /**
+     * Owns the single fullscreen screen of the application and the scenes shown on it.
+     * Switching scenes only changes which scene's component is shown, so the screen's loop runs once for the whole
+     * application and the terminal is set up and torn down only once, no matter how often scenes are switched.
+     */
+    class SceneManager
+    {
+    public:
+        explicit SceneManager(const ScreenOptions& options = {});
+
+        /**
+         * Makes the screen draw a new frame of the active scene. Can be called from any thread.
+         * Requests are paced, so many requests in quick succession result in a single frame.
+         */
+        void RequestRedraw();
+
+        /**
+         * Scheduler running the scenes' tasks on the UI thread. Its timers wake the screen's loop directly, so tasks run
+         * when they are due regardless of the frame rate, and the frame showing what they did is requested from the pacer.
+         */
+        CoroutineScheduler& Scheduler()
+        {
+            return scheduler;
+        }
+
+        /**
+         * Adds the given scene.
+         *
+         * @returns Index of the scene to switch to it.
+         */
+        int Add(std::unique_ptr<Scene> scene);
+
+        /**
+         * Leaves the active scene and enters the scene with the given index. Must be called from the UI thread.
+         */
+        void SwitchTo(int index);
+
+        /**
+         * Enters the scene with the given index and runs the screen's loop until the screen is exited.
+         */
+        void Run(int first_scene);
+
+    private:
+        /**
+         * Makes the screen's loop draw a frame. Called by the frame pacer.
+         */
+        void PostFrame();
+        /**
+         * Makes the screen's loop run the scheduler's due tasks, bypassing the frame pacer. Called by the scheduler's
+         * waker thread.
+         */
+        void WakeLoop();
+        ftxui::Element FrameStatsLine() const;
+        /**
+         * Percentiles of the profiled phases' durations, toggled with the P key.
+         */
+        ftxui::Element ProfileOverlay() const;
+        void UpdateProfiling();
+        void WriteProfile() const;
+
+        ftxui::ScreenInteractive screen;
+        /**
+         * Screen used instead of the ScreenInteractive for the Diff backend, null otherwise.
+         */
+        std::unique_ptr<TerminalScreen> terminal_screen;
+        FramePacer frame_pacer;
+        CoroutineScheduler scheduler;
+        /**
+         * Event posted by WakeLoop(), which runs the due tasks and requests a frame instead of reaching the scenes.
+         */
+        const ftxui::Event task_wake_event = ftxui::Event::Special("TaskWake");
+        bool show_frame_stats;
+        bool show_profile_overlay = false;
+        std::string profile_output;
+
+        std::vector<std::unique_ptr<Scene>> scenes;
+
+        /**
+         * Index of the active scene. Selects the shown tab of the screen's root container.
+         */
+        int active_scene = 0;
+    };
+}
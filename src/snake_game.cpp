@@ -1,9 +1,7 @@
+#include <algorithm>
 #include <format>
-#include <thread>
-#include <mutex>
-#include <deque>
+#include <limits>
 #include <unordered_set>
-#include <random>
 
 #include "ftxui/component/screen_interactive.hpp" // for ScreenInteractive
 #include "ftxui/component/component.hpp"          // for Menu
@@ -11,402 +9,386 @@
 #include "ftxui/component/event.hpp"
 
 #include "snake_game.h"
+#include "util/profiler.h"
+#include "util/tick_scheduler.h"
 #include "util/util.h"
 
 namespace TerminalMinigames
 {
     namespace Snake
     {
-        /**
-         * Instance of the game state struct.
-         */
-        SnakeGameState game_state;
-        /**
-         * Mutex for accessing the snake positions queue.
-         */
-        std::mutex snake_positions_mutex;
-        /**
-         * Mutex for accessing the food positions set.
-         */
-        std::mutex food_positions_mutex;
-
-        bool restart_flag;
-
-        SnakeConfig  snake_config;
-
-        std::random_device random_device;
-        std::mt19937 generator(random_device());
-        std::uniform_int_distribution<> uniform_distribution_x(snake_config.food_x_offset_min_factor, snake_config.food_x_offset_max_factor);
-        std::uniform_int_distribution<> uniform_distribution_y(snake_config.food_y_offset_min_factor, snake_config.food_y_offset_max_factor);
-
-        Pixel::Pixel(std::tuple<float, int> center)
-        {
-            SetCenter(center);
-        }
-
-        Pixel::Pixel(float center_x, int center_y)
+        void DrawCell(ftxui::Canvas* canvas, const SnakeConfig& config, Cell cell, ftxui::Color color)
         {
-            SetCenter(std::tuple<float, int> {center_x, center_y});
-        }
-
-        void Pixel::SetCenter(std::tuple<float, int> new_center)
-        {
-            center = new_center;
-
-            x1_y1 = { std::floor(std::get<0>(new_center)) - 1, std::get<1>(new_center) - 1 };
-            x2_y1 = { std::floor(std::get<0>(new_center)), std::get<1>(new_center) - 1 };
+            int center_x = config.grid_origin_x + config.CellX(cell) * config.movement_offset;
+            int center_y = config.grid_origin_y + config.CellY(cell) * config.movement_offset;
 
-            x3_y1 = { std::ceil(std::get<0>(new_center)), std::get<1>(new_center) - 1 };
-            x4_y1 = { std::ceil(std::get<0>(new_center)) + 1, std::get<1>(new_center) - 1 };
-
-            x1_y2 = { std::floor(std::get<0>(new_center)) - 1, std::get<1>(new_center) + 1 };
-            x2_y2 = { std::floor(std::get<0>(new_center)), std::get<1>(new_center) + 1 };
-
-            x3_y2 = { std::ceil(std::get<0>(new_center)), std::get<1>(new_center) + 1 };
-            x4_y2 = { std::ceil(std::get<0>(new_center)) + 1, std::get<1>(new_center) + 1 };
-        }
-
-        void Pixel::SetCenter(float new_center_x, int new_center_y)
-        {
-            center = std::tuple<int, int>{ new_center_x, new_center_y };
-
-            x1_y1 = { std::floor(new_center_x) - 1, new_center_y - 1 };
-            x2_y1 = { std::floor(new_center_x), new_center_y - 1 };
-
-            x3_y1 = { std::ceil(new_center_x), new_center_y - 1 };
-            x4_y1 = { std::ceil(new_center_x) + 1, new_center_y - 1 };
-
-            x1_y2 = { std::floor(new_center_x) - 1, new_center_y + 1 };
-            x2_y2 = { std::floor(new_center_x), new_center_y + 1 };
-
-            x3_y2 = { std::ceil(new_center_x), new_center_y + 1 };
-            x4_y2 = { std::ceil(new_center_x) + 1, new_center_y + 1 };
+            for (int x = center_x - 1; x <= center_x + 2; ++x)
+            {
+                (*canvas).DrawBlock(x, center_y - 1, true, color);
+                (*canvas).DrawBlock(x, center_y + 1, true, color);
+            }
         }
 
-        void Pixel::DrawPixel(ftxui::Canvas* canvas, ftxui::Color color)
+        void EraseCell(ftxui::Canvas* canvas, const SnakeConfig& config, Cell cell)
         {
-            (*canvas).DrawBlock(std::get<0>(x1_y1), std::get<1>(x1_y1), true, color);
-            (*canvas).DrawBlock(std::get<0>(x2_y1), std::get<1>(x2_y1), true, color);
-
-            (*canvas).DrawBlock(std::get<0>(x3_y1), std::get<1>(x3_y1), true, color);
-            (*canvas).DrawBlock(std::get<0>(x4_y1), std::get<1>(x4_y1), true, color);
+            int center_x = config.grid_origin_x + config.CellX(cell) * config.movement_offset;
+            int center_y = config.grid_origin_y + config.CellY(cell) * config.movement_offset;
 
-            (*canvas).DrawBlock(std::get<0>(x1_y2), std::get<1>(x1_y2), true, color);
-            (*canvas).DrawBlock(std::get<0>(x2_y2), std::get<1>(x2_y2), true, color);
-
-            (*canvas).DrawBlock(std::get<0>(x3_y2), std::get<1>(x3_y2), true, color);
-            (*canvas).DrawBlock(std::get<0>(x4_y2), std::get<1>(x4_y2), true, color);
+            for (int x = center_x - 1; x <= center_x + 2; ++x)
+            {
+                (*canvas).DrawBlockOff(x, center_y - 1);
+                (*canvas).DrawBlockOff(x, center_y + 1);
+            }
         }
 
-        void SpawnFood(SnakeGameState* current_game_state)
+        /**
+         * Takes the queued inputs up to and including the first one that turns the snake.
+         * Inputs that would not turn the snake are dropped, later ones stay queued for the following ticks,
+         * so quick successive turns are applied one per tick instead of overwriting each other.
+         */
+        InputDirection NextTurn(SnakeSession& session)
         {
-            int new_x_factor = uniform_distribution_x(generator);
-            int new_y_factor = uniform_distribution_y(generator);
-
-            Pixel food_position(3.5f + new_x_factor * snake_config.movement_offset, 5 + new_y_factor * snake_config.movement_offset);
-
-            while (std::find_if(game_state.snake_position_queue.begin(), game_state.snake_position_queue.end(), Pixel(food_position)) != game_state.snake_position_queue.end())
+            while (auto event = session.inputs.TryReceive())
             {
-                food_position.SetCenter(3.5f + uniform_distribution_x(generator) * snake_config.movement_offset, 5 + uniform_distribution_y(generator) * snake_config.movement_offset);
+                if (session.simulation.IsTurn(event->direction))
+                {
+                    auto latency = std::chrono::steady_clock::now() - event->timestamp;
+                    session.input_latency.Record(std::chrono::duration<double, std::milli>(latency).count());
+                    return event->direction;
+                }
             }
-
-            (*current_game_state).food_positions.insert(food_position);
+            return InputDirection::None;
         }
 
-        void HandleInput(Pixel* new_head_pos, SnakeGameState* current_game_state, MovementDirection new_direction, int x_offset, int y_offset)
+        void CaptureSnapshot(const SnakeSimulation& simulation, std::uint64_t game, SnakeSnapshot& snapshot)
         {
-            (*current_game_state).current_movement_direction = new_direction;
-
-            (*new_head_pos).SetCenter(std::tuple<float, int> {std::get<0>((*new_head_pos).center) + x_offset, std::get<1>((*new_head_pos).center) + y_offset});
-        }
+            const SnakeGameState& state = simulation.State();
 
-        void HandleLeftRightMovement(Pixel* new_head_pos, SnakeGameState* current_game_state, bool moves_left)
-        {
-            switch (game_state.last_input)
+            // The snapshot still holds the snake of an earlier tick, so only the cells the head moved to
+            // are added and the ones the tail left are dropped
+            const auto& snake = state.snake_position_queue;
+            size_t new_cells = state.moves - snapshot.moves;
+            if (snapshot.game != game || new_cells > snake.Size())
             {
-            case InputDirection::None:
-            case InputDirection::Left:
-            case InputDirection::Right:
+                snapshot.snake_cells = snake;
+            }
+            else
             {
-                if (moves_left)
+                while (snapshot.snake_cells.Size() + new_cells > snake.Size())
                 {
-                    (*new_head_pos).SetCenter(std::tuple<float, int> {std::get<0>((*new_head_pos).center) - snake_config.movement_offset, std::get<1>((*new_head_pos).center)});
+                    snapshot.snake_cells.PopBack();
                 }
-                else
+                for (size_t index = new_cells; index-- > 0;)
                 {
-                    (*new_head_pos).SetCenter(std::tuple<float, int> {std::get<0>((*new_head_pos).center) + snake_config.movement_offset, std::get<1>((*new_head_pos).center)});
+                    snapshot.snake_cells.PushFront(snake[index]);
                 }
-                break;
-            }
-            case InputDirection::Up:
-            {
-                HandleInput(new_head_pos, current_game_state, MovementDirection::Up, 0, -snake_config.movement_offset);
-                break;
-            }
-            case InputDirection::Down:
-            {
-                HandleInput(new_head_pos, current_game_state, MovementDirection::Down, 0, snake_config.movement_offset);
-                break;
-            }
             }
+            snapshot.game = game;
+            snapshot.moves = state.moves;
+            snapshot.seed = simulation.Seed();
+            snapshot.food_positions.assign(state.food_positions.begin(), state.food_positions.end());
+
+            snapshot.isDead = state.isDead;
+            snapshot.won = state.won;
+            snapshot.tick_rate = simulation.TickRate();
+        }
+
+        /**
+         * Brings the session's snapshot up to date with its simulation's current state.
+         */
+        void UpdateSnapshot(SnakeSession& session, const LatencyStats& tick_jitter)
+        {
+            CaptureSnapshot(session.simulation, session.game_count, session.snapshot);
+            session.snapshot.tick_jitter = tick_jitter;
+            session.snapshot.input_latency = session.input_latency;
         }
 
-        void HandleUpDownMovement(Pixel* new_head_pos, SnakeGameState* current_game_state, bool moves_up)
+        Task Update(CoroutineScheduler& scheduler, SnakeSession& session, std::uint64_t seed)
         {
-            switch (game_state.last_input)
-            {
-            case InputDirection::None:
-            case InputDirection::Down:
-            case InputDirection::Up:
+            SnakeSimulation& simulation = session.simulation;
+            TickScheduler ticks;
+            ticks.Start();
+            session.inputs.Clear();
+
+            simulation.Reset(seed);
+            ++session.game_count;
+            UpdateSnapshot(session, ticks.Jitter());
+
+            while (!simulation.IsOver())
             {
-                if (moves_up)
-                {
-                    (*new_head_pos).SetCenter(std::tuple<float, int> {std::get<0>((*new_head_pos).center), std::get<1>((*new_head_pos).center) - snake_config.movement_offset});
-                }
-                else
+                // wait until the deadline of the next tick before updating position:
+                auto period = std::chrono::duration_cast<TickScheduler::Clock::duration>(std::chrono::duration<double>(1.0 / simulation.TickRate()));
+                co_await scheduler.SleepUntil(ticks.NextTick(period));
+                ticks.RecordWakeUp(period);
+
                 {
-                    (*new_head_pos).SetCenter(std::tuple<float, int> {std::get<0>((*new_head_pos).center), std::get<1>((*new_head_pos).center) + snake_config.movement_offset});
+                    ProfileScope profile(ProfilePhase::SimulationStep);
+                    InputDirection turn = NextTurn(session);
+                    session.recording.Input(turn);
+                    simulation.Step(turn);
+                    session.recording.Tick();
                 }
-                break;
+                UpdateSnapshot(session, ticks.Jitter());
             }
-            case InputDirection::Left:
+            session.recording.GameOver();
+        }
+
+        const ftxui::Canvas& BoardCanvas::Update(const SnakeSnapshot& snapshot)
+        {
+            bool is_over = snapshot.won || snapshot.isDead;
+            if (snapshot.game != drawn_game || is_over != drawn_over || snapshot.moves - drawn_moves > snapshot.snake_cells.Size())
             {
-                HandleInput(new_head_pos, current_game_state, MovementDirection::Left, -snake_config.movement_offset, 0);
-                break;
+                Rebuild(snapshot);
             }
-            case InputDirection::Right:
+            else if (!is_over)
             {
-                HandleInput(new_head_pos, current_game_state, MovementDirection::Right, snake_config.movement_offset, 0);
-                break;
-            }
+                ApplyChanges(snapshot);
             }
+            return canvas;
         }
 
-        void Update(ftxui::ScreenInteractive& screen, SnakeGameState& state, bool* back_flag)
+        void BoardCanvas::Rebuild(const SnakeSnapshot& snapshot)
         {
-            int seconds_passed_since_last_food_spawn = 0;
+            canvas = ftxui::Canvas(config.board_dimension_x, config.board_dimension_y);
 
-            food_positions_mutex.lock();
-            SpawnFood(&state);
-            food_positions_mutex.unlock();
+            // Draw custom border around canvas:
+            canvas.DrawBlockLine(0, 2, canvas.width(), 2); // top border
 
-            while (!(*back_flag) && !state.isDead)
-                //while (!game_state.isDead)
-            {
-                // wait certain amount of time before updating position:
-                using namespace std::chrono_literals;
-                std::this_thread::sleep_for(0.5s);
+            canvas.DrawBlockLine(0, 2, 0, canvas.height() - 3); // left border (part 1)
+            canvas.DrawBlockLine(1, 2, 1, canvas.height() - 3); // left border (part 2)
 
-                // Fetch required locks
-                snake_positions_mutex.lock();
-                food_positions_mutex.lock();
+            canvas.DrawBlockLine(canvas.width() - 1, 2, canvas.width() - 1, canvas.height() - 3); // right border (part 1)
+            canvas.DrawBlockLine(canvas.width() - 2,  2, canvas.width() - 2, canvas.height() - 3); // right border (part 1)
 
-                // handle input (if present) and move the snake
-                auto new_head_pos = state.snake_position_queue.front();
+            canvas.DrawBlockLine(0, canvas.height() - 3, canvas.width() - 1, canvas.height() - 3); // bottom border
 
-                switch (state.current_movement_direction)
-                {
-                case MovementDirection::Left:
-                case MovementDirection::Right:
+            if (snapshot.won)
+            {
+                PrintWonMessageToCanvas(canvas, Vector2D::Vector2D(56, 28));
+            }
+            else if (!snapshot.isDead)
+            {
+                // Draw food on canvas:
+                for (Cell food : snapshot.food_positions)
                 {
-                    HandleLeftRightMovement(&new_head_pos, &state, state.current_movement_direction == MovementDirection::Left);
-                    break;
+                    DrawCell(&canvas, config, food, ftxui::Color::Red);
                 }
-                case MovementDirection::Up:
-                case MovementDirection::Down:
+
+                // Draw Snake on canvas:
+                for (auto segment : { snapshot.snake_cells.FirstSegment(), snapshot.snake_cells.SecondSegment() })
                 {
-                    HandleUpDownMovement(&new_head_pos, &state, state.current_movement_direction == MovementDirection::Up);
-                    break;
-                }
+                    for (Cell cell : segment)
+                    {
+                        DrawCell(&canvas, config, cell, ftxui::Color::Green);
+                    }
                 }
-
-                // Check if new_head_pos is already contained in snake_position_queue or is out of bounds:
-                if (std::find_if(state.snake_position_queue.begin(), state.snake_position_queue.end(), Pixel(new_head_pos)) != state.snake_position_queue.end()
-                    || std::get<0>(new_head_pos.center) > snake_config.max_x_dimension
-                    || std::get<0>(new_head_pos.center) < snake_config.min_x_dimension
-                    || std::get<1>(new_head_pos.center) > snake_config.max_y_dimension
-                    || std::get<1>(new_head_pos.center) < snake_config.min_y_dimension)
+                if (!snapshot.snake_cells.Empty())
                 {
-                    state.isDead = true;
-                    screen.PostEvent(ftxui::Event::Custom);
-                    snake_positions_mutex.unlock();
-                    food_positions_mutex.unlock();
-                    break;
+                    DrawCell(&canvas, config, snapshot.snake_cells.Front(), ftxui::Color::LightGreen);
                 }
+            }
+            else
+            {
+                PrintGameOverToCanvas(canvas, Vector2D::Vector2D(36, 28));
+            }
+
+            drawn_game = snapshot.game;
+            drawn_moves = snapshot.moves;
+            drawn_over = snapshot.won || snapshot.isDead;
+            drawn_cells = snapshot.snake_cells;
+            drawn_food = snapshot.food_positions;
+        }
 
-                state.snake_position_queue.push_front(new_head_pos);
+        void BoardCanvas::ApplyChanges(const SnakeSnapshot& snapshot)
+        {
+            size_t new_cells = snapshot.moves - drawn_moves;
+
+            // Clear the cells the tail left first, the head may have moved into one of them
+            while (drawn_cells.Size() + new_cells > snapshot.snake_cells.Size())
+            {
+                EraseCell(&canvas, config, drawn_cells.Back());
+                drawn_cells.PopBack();
+            }
 
-                // Check if new_head_pos is contained in food_positions => snake is eating
-                bool is_eating = state.food_positions.contains(new_head_pos);
-                if (is_eating)
+            // Food eaten in the meantime is covered by the snake again below
+            for (Cell food : drawn_food)
+            {
+                if (std::find(snapshot.food_positions.begin(), snapshot.food_positions.end(), food) == snapshot.food_positions.end())
                 {
-                    state.food_positions.erase(new_head_pos);
-                    SpawnFood(&state);
+                    EraseCell(&canvas, config, food);
                 }
-                else
+            }
+            for (Cell food : snapshot.food_positions)
+            {
+                if (std::find(drawn_food.begin(), drawn_food.end(), food) == drawn_food.end())
                 {
-                    state.snake_position_queue.pop_back();
+                    DrawCell(&canvas, config, food, ftxui::Color::Red);
                 }
+            }
+            drawn_food = snapshot.food_positions;
 
-                if (seconds_passed_since_last_food_spawn > 20)
+            if (new_cells > 0)
+            {
+                if (!drawn_cells.Empty())
                 {
-                    SpawnFood(&state);
-                    seconds_passed_since_last_food_spawn = 0;
+                    DrawCell(&canvas, config, drawn_cells.Front(), ftxui::Color::Green);
                 }
-                else
+                for (size_t index = new_cells; index-- > 0;)
                 {
-                    seconds_passed_since_last_food_spawn++;
+                    drawn_cells.PushFront(snapshot.snake_cells[index]);
+                    DrawCell(&canvas, config, drawn_cells.Front(), ftxui::Color::Green);
                 }
-
-                state.last_input = InputDirection::None;
-
-                food_positions_mutex.unlock();
-                snake_positions_mutex.unlock();
-
-                screen.PostEvent(ftxui::Event::Custom);
+                DrawCell(&canvas, config, drawn_cells.Front(), ftxui::Color::LightGreen);
             }
+            drawn_moves = snapshot.moves;
         }
 
-        void UpdateScreen(ftxui::ScreenInteractive& screen, ftxui::Component& comp)
+        namespace
         {
-            screen.Loop(comp);
-        }
-
-        void ExecuteSnake(QuitFunction quit_function, bool* back_to_menu)
-        {
-            game_state.Reset();
-
-            auto screen = ftxui::ScreenInteractive::Fullscreen();
-            auto container = ftxui::Container::Vertical({});
-
-            auto board_renderer = ftxui::Renderer([&]
+            /**
+             * Scene showing the snake game. Starts a new game whenever it is entered.
+             */
+            class SnakeScene : public Scene
+            {
+            public:
+                SnakeScene(CoroutineScheduler& scheduler, QuitFunction quit_function, std::uint64_t seed, ReplayRecorder* recorder)
+                    : scheduler(scheduler), recorder(recorder), next_seed(seed)
                 {
-                    auto canvas = ftxui::Canvas(snake_config.board_dimension_x, snake_config.board_dimension_y);
-
-                    // Draw custom border around canvas:
-                    canvas.DrawBlockLine(0, 2, canvas.width(), 2); // top border
-
-                    canvas.DrawBlockLine(0, 2, 0, canvas.height() - 3); // left border (part 1)
-                    canvas.DrawBlockLine(1, 2, 1, canvas.height() - 3); // left border (part 2)
+                    auto container = ftxui::Container::Vertical({});
 
-                    canvas.DrawBlockLine(canvas.width() - 1, 2, canvas.width() - 1, canvas.height() - 3); // right border (part 1)
-                    canvas.DrawBlockLine(canvas.width() - 2,  2, canvas.width() - 2, canvas.height() - 3); // right border (part 1)
-
-                    canvas.DrawBlockLine(0, canvas.height() - 3, canvas.width() - 1, canvas.height() - 3); // bottom border
-
-                    if (!game_state.isDead)
-                    {
-                        // Fetch all necessary locks
-                        snake_positions_mutex.lock();
-                        food_positions_mutex.lock();
-
-                        // Draw food on canvas:
-                        for (auto food : game_state.food_positions)
+                    auto board_renderer = ftxui::Renderer([this]
                         {
-                            food.DrawPixel(&canvas, ftxui::Color::Red);
+                            ProfileScope profile(ProfilePhase::BoardCanvas);
+                            return ftxui::canvas(&board.Update(session.snapshot));
+                        });
+
+                    container->Add(board_renderer);
+
+                    // Quit button
+                    auto quit_button = ftxui::Button(&quit_button_label, quit_function);
+                    container->Add(quit_button);
+
+                    // Restart button
+                    auto restart_button = ftxui::Button(&restart_button_label, [this] { StartNewGame(); });
+                    container->Add(restart_button);
+
+                    auto game_view_renderer = ftxui::Renderer(container, [=, this]
+                                                    { 
+                                                        const SnakeSnapshot& snapshot = session.snapshot;
+                                                        std::string length_text;
+                                                        std::string tick_text;
+                                                        {
+                                                            ProfileScope profile(ProfilePhase::StatusText);
+                                                            length_text = std::format("Length: {}  Seed: {}", snapshot.snake_cells.Size(), snapshot.seed);
+                                                            tick_text = std::format("Speed: {:.2f} ticks/s  Jitter: {:.1f} ms avg, {:.1f} ms max  Input latency: {:.1f} ms avg",
+                                                                snapshot.tick_rate, snapshot.tick_jitter.average_ms, snapshot.tick_jitter.max_ms, snapshot.input_latency.average_ms);
+                                                        }
+
+                                                        return ftxui::vbox({ 
+                                                            ftxui::text("Terminal Minigames") | ftxui::bold | ftxui::center, 
+                                                            ftxui::text(length_text), 
+                                                            ftxui::text(tick_text), 
+                                                            ftxui::hbox({
+                                                                board_renderer->Render(),
+                                                                ftxui::vbox({
+                                                                    quit_button->Render(),
+                                                                    restart_button->Render(),
+                                                                    ftxui::filler()
+                                                                })
+                                                            })
+                                                        }); 
+                                                    });
+            
+                    auto game_view_event_catch_wrapper = ftxui::CatchEvent(game_view_renderer, [this](ftxui::Event e) {
+                        InputDirection direction = InputDirection::None;
+                        if (e == ftxui::Event::ArrowLeft)
+                        {
+                            direction = InputDirection::Left;
                         }
-
-                        // Draw Snake on canvas:
-                        for (int index = 0; index < game_state.snake_position_queue.size(); ++index)
+                        else if (e == ftxui::Event::ArrowRight)
+                        {
+                            direction = InputDirection::Right;
+                        }
+                        else if (e == ftxui::Event::ArrowDown)
+                        {
+                            direction = InputDirection::Down;
+                        }
+                        else if (e == ftxui::Event::ArrowUp)
+                        {
+                            direction = InputDirection::Up;
+                        }
+                        else
                         {
-                            if (index == 0)
-                            {
-                                game_state.snake_position_queue[index].DrawPixel(&canvas, ftxui::Color::LightGreen);
-                            }
-                            else
-                            {
-                                game_state.snake_position_queue[index].DrawPixel(&canvas, ftxui::Color::Green);
-                            }
+                            return false;
                         }
 
-                        // Unlock all mutexes
-                        snake_positions_mutex.unlock();
-                        food_positions_mutex.unlock();
-                    } 
-                    else
-                    {
-                        PrintGameOverToCanvas(canvas, Vector2D::Vector2D(36, 28));
-                    }
-                    
-                    return ftxui::canvas(std::move(canvas));
-                });
-
-            container->Add(board_renderer);
-
-            // Quit button
-            std::string quit_button_label = "Back to Menu";
-            auto quit_button = ftxui::Button(&quit_button_label, [&] { quit_function(); });
-            container->Add(quit_button);
-
-            // Restart button
-            std::string restart_button_label = "Restart";
-            auto restart_button = ftxui::Button(&restart_button_label, [&] {
-                game_state.Reset();
-                restart_flag = true; });
-            container->Add(restart_button);
-
-            auto game_view_renderer = ftxui::Renderer(container, [&]
-                                            { 
-                                                auto length_text = std::format("Length: {}", game_state.snake_position_queue.size());
-
-                                                return ftxui::vbox({ 
-                                                    ftxui::text("Terminal Minigames") | ftxui::bold | ftxui::center, 
-                                                    ftxui::text(length_text), 
-                                                    ftxui::hbox({
-                                                        board_renderer->Render(),
-                                                        ftxui::vbox({
-                                                            quit_button->Render(),
-                                                            restart_button->Render(),
-                                                            ftxui::filler()
-                                                        })
-                                                    })
-                                                }); 
-                                            });
-        
-            auto game_view_event_catch_wrapper = ftxui::CatchEvent(game_view_renderer, [&](ftxui::Event e) {
-                if (e == ftxui::Event::ArrowLeft)
-                {
-                    game_state.last_input = InputDirection::Left;
-                    return true;
-                }
-                else if (e == ftxui::Event::ArrowRight)
-                {
-                    game_state.last_input = InputDirection::Right;
-                    return true;
+                        // A full queue means the player is far ahead of the snake; drop the input
+                        session.inputs.Push({ direction, std::chrono::steady_clock::now() });
+                        return true;
+                        });
+
+                    root = game_view_event_catch_wrapper;
                 }
-                else if (e == ftxui::Event::ArrowDown)
+
+                ftxui::Component Root() override
                 {
-                    game_state.last_input = InputDirection::Down;
-                    return true;
+                    return root;
                 }
-                else if (e == ftxui::Event::ArrowUp)
+
+                void Enter() override
                 {
-                    game_state.last_input = InputDirection::Up;
-                    return true;
+                    StartNewGame();
                 }
 
-                return false;
-                });
-
-            std::thread update_screen(UpdateScreen, std::ref(screen), std::ref(game_view_event_catch_wrapper));
-            
-            std::thread update_snake;
-            restart_flag = true;
-            while (!(*back_to_menu))
-            {
-                if (restart_flag)
+                void Leave() override
                 {
-                    update_snake = std::thread(Update, std::ref(screen), std::ref(game_state), back_to_menu);
-                    restart_flag = false;
-                    screen.PostEvent(ftxui::Event::Custom);
+                    scheduler.Cancel(update_task);
+                    session.recording = {};
                 }
-                if (update_snake.joinable())
+
+            private:
+                /**
+                 * Replaces the running update task, if any, with a fresh one, which starts a new game.
+                 */
+                void StartNewGame()
                 {
-                    update_snake.join();
+                    scheduler.Cancel(update_task);
+                    if (recorder)
+                    {
+                        Replay header;
+                        header.game = ReplayGame::Snake;
+                        header.seed = next_seed;
+                        header.snake_config = session.simulation.Config();
+                        session.recording = recorder->Record(header);
+                    }
+
+                    update_task = scheduler.Spawn(Update(scheduler, session, next_seed));
+                    next_seed = NextGameSeed(next_seed);
                 }
-            }
 
-            update_screen.join();
+                CoroutineScheduler& scheduler;
+                /**
+                 * Recorder to record every game with, if replays are recorded.
+                 */
+                ReplayRecorder* recorder;
+                TaskId update_task = 0;
+                /**
+                 * Seed of the next game. Derived from the previous game's seed, so a run's games follow from the seed
+                 * of its first game and any game can be played again by passing its seed.
+                 */
+                std::uint64_t next_seed;
+                SnakeSession session;
+                BoardCanvas board{ session.simulation.Config() };
+
+                std::string quit_button_label = "Back to Menu";
+                std::string restart_button_label = "Restart";
+                ftxui::Component root;
+            };
+        }
+
+        std::unique_ptr<Scene> CreateSnakeScene(CoroutineScheduler& scheduler, QuitFunction quit_function, std::uint64_t seed, ReplayRecorder* recorder)
+        {
+            return std::make_unique<SnakeScene>(scheduler, std::move(quit_function), seed, recorder);
         }
     } // namespace Snake
 } // namespace TerminalMinigames
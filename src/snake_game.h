@@ -1,8 +1,19 @@
 #pragma once
 
-#include <unordered_set>
-#include <random>
-
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <vector>
+
+#include "ftxui/dom/canvas.hpp"
+
+#include "replay.h"
+#include "scene_manager.h"
+#include "snake_simulation.h"
+#include "util/coroutine_scheduler.h"
+#include "util/input_direction.h"
+#include "util/latency_stats.h"
+#include "util/ring_buffer.h"
 #include "util/util.h"
 
 namespace TerminalMinigames
@@ -10,240 +21,156 @@ namespace TerminalMinigames
     namespace Snake
     {
         /**
-         * Enum listing all the avilable movement directions for the snake.
+         * Everything needed to draw one frame of the game. Brought up to date by the update task after every tick
+         * and read when drawing, so drawing does not depend on the simulation's internal state.
          */
-        enum class MovementDirection
+        struct SnakeSnapshot
         {
-            Left,
-            Right,
-            Up,
-            Down
+            /**
+             * Number of the game the snapshot belongs to. Changes whenever a new game is started.
+             */
+            std::uint64_t game = 0;
+            /**
+             * Number of cells the snake's head moved since the start of the game.
+             */
+            std::uint64_t moves = 0;
+            /**
+             * Seed of the game, which plays the same game again when passed on the command line.
+             */
+            std::uint64_t seed = 0;
+            /**
+             * Cells covered by the snake, starting with its head.
+             */
+            RingBuffer<Cell> snake_cells;
+            std::vector<Cell> food_positions;
+            bool isDead = false;
+            bool won = false;
+            double tick_rate = 0.0;
+            LatencyStats tick_jitter;
+            LatencyStats input_latency;
         };
 
         /**
-         * Creates a bigger representation of a coordinate of the snake by wrapping it in a 2x1 container.
-         * Required to prevent visualization by a block with questionmark. Looks nicer this way.
+         * Prints the given cell to the given canvas in the given color.
+         * A cell is drawn as 2x4 blocks around its center to prevent visualization by a block with questionmark.
+         *
+         * @param canvas Canvas pointer to print to.
+         * @param config Configuration defining the cell grid.
+         * @param cell Cell to print.
+         * @param color Color to print the cell in.
          */
-        struct Pixel
-        {
-            std::tuple<int, int> x1_y1;
-            std::tuple<int, int> x2_y1;
-
-            std::tuple<int, int> x3_y1;
-            std::tuple<int, int> x4_y1;
-
-            std::tuple<int, int> x1_y2;
-            std::tuple<int, int> x2_y2;
-
-            std::tuple<int, int> x3_y2;
-            std::tuple<int, int> x4_y2;
+        void DrawCell(ftxui::Canvas* canvas, const SnakeConfig& config, Cell cell, ftxui::Color color);
 
-            std::tuple<float, int> center; // min: (2,2); max: (97,47)
-
-            Pixel(std::tuple<float, int> center);
-            Pixel(float center_x, int center_y);
+        /**
+         * Clears the blocks printed by DrawCell for the given cell.
+         *
+         * @param canvas Canvas pointer to clear the cell on.
+         * @param config Configuration defining the cell grid.
+         * @param cell Cell to clear.
+         */
+        void EraseCell(ftxui::Canvas* canvas, const SnakeConfig& config, Cell cell);
 
-            void SetCenter(std::tuple<float, int> new_center);
-            void SetCenter(float new_center_x, int new_center_y);
+        /**
+         * Brings the given snapshot up to date with the simulation's current state. If the snapshot already holds an
+         * earlier tick of the same game, only the cells the snake moved are copied.
+         *
+         * @param simulation Simulation to capture.
+         * @param game Number of the simulation's current game.
+         * @param snapshot Snapshot to update. Its tick jitter and input latency are left unchanged.
+         */
+        void CaptureSnapshot(const SnakeSimulation& simulation, std::uint64_t game, SnakeSnapshot& snapshot);
 
+        /**
+         * Board of the game drawn into a canvas that is kept between frames. Only the cells that changed since the
+         * last drawn snapshot are drawn, so a frame costs the same no matter how long the snake is.
+         * The whole board is only drawn again when a new game starts and when the game ends.
+         */
+        class BoardCanvas
+        {
+        public:
             /**
-             * Prints the pixel to the given canvas in the given color by printing the individual points as blocks.
-             * 
-             * @param canvas Canvas pointer to print to.
-             * @param color Color to print the pixel in.
+             * @param config Configuration of the games to draw, defining the board size and cell grid.
              */
-            void DrawPixel(ftxui::Canvas* canvas, ftxui::Color color);
+            explicit BoardCanvas(const SnakeConfig& config) : config(config)
+            {
+            }
 
             /**
-             * Allows comparison with other pixels whether they point to the same coordinates (center).
-             * @param other_pixel Pixel to compare to.
+             * Brings the canvas up to date with the given snapshot.
              */
-            bool operator()(const Pixel& other_pixel) const
-            {
-                return std::floor(std::get<0>(center)) == std::floor(std::get<0>(other_pixel.center)) && std::get<1>(center) == std::get<1>(other_pixel.center);
-            }
+            const ftxui::Canvas& Update(const SnakeSnapshot& snapshot);
 
-            bool operator==(const Pixel& other_pixel) const
-            {
-                return std::floor(std::get<0>(center)) == std::floor(std::get<0>(other_pixel.center)) && std::get<1>(center) == std::get<1>(other_pixel.center);
-            }
+        private:
+            void Rebuild(const SnakeSnapshot& snapshot);
+            void ApplyChanges(const SnakeSnapshot& snapshot);
 
-            struct HashFunction
-            {
-                size_t operator()(const Pixel& pixel) const
-                {
-                    size_t x_hash = std::hash<int>()(std::floor(std::get<0>(pixel.center)));
-                    size_t y_hash = std::hash<int>()(std::get<1>(pixel.center));
-                    return x_hash ^ y_hash;
-                }
-            };
-        };
+            SnakeConfig config;
+            ftxui::Canvas canvas;
 
-        /**
-         * Struct containing all the information required for maintaining the current state of the game.
-         */
-        struct SnakeGameState
-        {
-            /**
-             * Flag whether the player died or not.
-             */
-            bool isDead = false;
             /**
-             * Length of the snake.
+             * State of the game the canvas shows. The game number starts out invalid so the first update draws the whole board.
              */
-            int snake_length = 4;
-            /**
-             * Double-ended queue containing the snake's positions in form of TerminalMinigames::Pixel instances.
-             */
-            std::deque<Pixel> snake_position_queue = {
-                    Pixel(47.5f, 25),
-                    Pixel(51.5f, 25),
-                    Pixel(55.5f, 25),
-                    Pixel(59.5f, 25) };
-            /**
-             * Last input caught.
-             */
-            std::atomic<InputDirection> last_input = InputDirection::None ;
-            /**
-             * Current movement direction of the snake.
-             */
-            std::atomic<MovementDirection> current_movement_direction = MovementDirection::Left;
-            /**
-             * Set containing the positions of the food for the snake.
-             */
-            std::unordered_set<Pixel, Pixel::HashFunction> food_positions = {};
-        
-            /**
-             * Resets the game state to start a fresh game.
-             */
-            void Reset()
-            {
-                isDead = false;
-                snake_length = 4;
-                snake_position_queue = {
-                    Pixel(47.5f, 25),
-                    Pixel(51.5f, 25),
-                    Pixel(55.5f, 25),
-                    Pixel(59.5f, 25) };
-                last_input = InputDirection::None;
-                current_movement_direction = MovementDirection::Left;
-                food_positions.clear();
-            }
+            std::uint64_t drawn_game = std::numeric_limits<std::uint64_t>::max();
+            std::uint64_t drawn_moves = 0;
+            bool drawn_over = false;
+            RingBuffer<Cell> drawn_cells;
+            std::vector<Cell> drawn_food;
         };
 
         /**
-         * Structure defining the configuration of the Snake game.
+         * Game played by a snake scene: the simulation and the state its update task shares with the scene.
+         * Only accessed by the UI thread, which runs the task.
          */
-        struct SnakeConfig
+        struct SnakeSession
         {
             /**
-             * Size of the step to move a TerminalMinigames::Pixel's center point to move it on the canvas.
+             * Simulation driven by the update task.
              */
-            int movement_offset = 4;
-
+            SnakeSimulation simulation;
             /**
-             * Width of the canvas.
+             * State of the simulation after its latest tick, which the board and status lines are drawn from.
              */
-            int board_dimension_x = 200;
+            SnakeSnapshot snapshot;
             /**
-             * Height of the canvas.
+             * Inputs caught by the UI, in order, to be consumed by the ticks of the update task.
              */
-            int board_dimension_y = 100;
+            EventChannel<InputEvent, 64> inputs;
             /**
-             * Min position on the x-axis to put a pixel's center.
+             * Recording of the inputs of the current game, which records nothing unless replays are recorded.
              */
-            const int min_x_dimension = 3;
+            ReplayRecording recording;
             /**
-             * Min position on the y-axis to put a pixel's center.
+             * Time from catching an input until the tick that applied it.
              */
-            const int min_y_dimension = 3;
-            /**
-             * Max position on the x-axis to put a pixel's center.
-             */
-            const int max_x_dimension = 196;
-            /**
-             * Max position on the y-axis to put a pixel's center.
-             */
-            const int max_y_dimension = 96;
-
+            LatencyStats input_latency;
             /**
-             * Max factor to multiply the movement_offset by to position the food on the x-axis of the canvas.
+             * Number of games started.
              */
-            const int food_x_offset_max_factor = 48;
-            /**
-             * Min factor to multiply the movement_offset by to position the food on the x-axis of the canvas.
-             */
-            const int food_x_offset_min_factor = 1;
-            /**
-             * Max factor to multiply the movement_offset by to position the food on the y-axis of the canvas.
-             */
-            const int food_y_offset_max_factor = 22;
-            /**
-             * Min factor to multiply the movement_offset by to position the food on the y-axis of the canvas.
-             */
-            const int food_y_offset_min_factor = 1;
+            std::uint64_t game_count = 0;
         };
 
         /**
-         * Spawns food by putting it in the passed game state's food position set.
-         * The newly added food position is then drawn on the next draw call of the canvas.
-         * 
-         * @param current_game_state Current game state to add to its food positions.
-         */
-        void SpawnFood(SnakeGameState* current_game_state);
-
-        /**
-         * Handles movement when an input was received.
-         * 
-         * @param new_head_pos New head position pixel.
-         * @param current_game_state Pointer to current game state.
-         * @param new_direction Direction to move the snake to.
-         * @param x_offset Offset to move the pixel along the x-axis by.
-         * @param y_offset Offset to move the pixel along the y-axis by.
-         */
-        void HandleInput(Pixel* new_head_pos, SnakeGameState* current_game_state, MovementDirection new_direction, int x_offset, int y_offset);
-        /**
-         * Handles snake movement when the movement direction is either left or right.
-         * 
-         * @param new_head_pos Pointer to new head position.
-         * @param current_game_state Pointer to current game state.
-         * @param moves_left Whether to move left (or right).
-         */
-        void HandleLeftRightMovement(Pixel* new_head_pos, SnakeGameState* current_game_state, bool moves_left);
-        
-        /**
-         * Handles snake movement when the movement direction is either up or down.
-         * 
-         * @param new_head_pos Poniter to new head position.
-         * @param current_game_state Pointer to current game state.
-         * @param moves_up Whether to move up (or down).
-         */
-        void HandleUpDownMovement(Pixel* new_head_pos, SnakeGameState* current_game_state, bool moves_up);
-    
-        /**
-         * Main function for the snake game.
+         * Creates the scene of the snake game. A new game is started whenever the scene is entered
+         * and its update task is cancelled when the scene is left.
+         *
+         * @param scheduler Scheduler of the UI thread to run the update task on.
          * @param quit_function Function executed when the player presses the back to menu button.
-         * @param back_to_menu Flag whether the player wants to go back to the menu. Required by the main menu.
-         */        
-        void ExecuteSnake(QuitFunction quit_function, bool* back_to_menu);
-
-        /**
-         * Update function for the snake game.
-         * 
-         * @param screen Reference to screen to post events to.
-         * @param state Reference to current game state.
-         * @param back_flag Whether to return to the menu or not.
+         * @param seed Seed of the first game. Each following game is seeded with a seed derived from the previous one.
+         * @param recorder Recorder to record a replay of every game with, or null to record none.
          */
-        void Update(ftxui::ScreenInteractive& screen, SnakeGameState& state, bool* back_flag);
+        std::unique_ptr<Scene> CreateSnakeScene(CoroutineScheduler& scheduler, QuitFunction quit_function, std::uint64_t seed, ReplayRecorder* recorder);
 
         /**
-         * Triggers the screen's loop function with the given component.
-         * Use in an individual thread.
-         * 
-         * @param screen Screen reference to loop.
-         * @param comp Component to loop on the screen.
+         * Update task for the snake game. Starts a new game and steps the simulation with the caught inputs
+         * at deadlines spaced by the simulation's current tick rate, updating the snapshot after every tick.
+         * Every tick and applied turn is added to the game's replay recording.
+         * The frame showing a tick is drawn right after the task suspends, as the task runs on the UI thread.
+         *
+         * @param scheduler Scheduler the task runs on.
+         * @param session Session whose simulation to step with its inputs, and whose snapshot and recording to update.
+         * @param seed Seed of the new game.
          */
-        void UpdateScreen(ftxui::ScreenInteractive& screen, ftxui::Component& comp);
+        Task Update(CoroutineScheduler& scheduler, SnakeSession& session, std::uint64_t seed);
 
     } // namespace Snake
 } // namespace TerminalMinigames
@@ -0,0 +1,177 @@
+#include "snake_simulation.h"
+
+namespace TerminalMinigames
+{
+    namespace Snake
+    {
+        SnakeSimulation::SnakeSimulation(SnakeConfig config, std::uint64_t seed) : config(config), seed(seed)
+        {
+            Reset(seed);
+        }
+
+        void SnakeSimulation::Reset(std::uint64_t new_seed)
+        {
+            seed = new_seed;
+            generator.Seed(seed);
+
+            state.isDead = false;
+            state.won = false;
+            state.current_movement_direction = MovementDirection::Left;
+            state.food_positions.clear();
+            state.food_positions.reserve(config.CellCount());
+            state.seconds_since_food_spawn = 0.0;
+            state.moves = 0;
+
+            state.snake_position_queue.Reserve(config.CellCount());
+            state.snake_occupancy.Resize(config.GridWidth(), config.GridHeight());
+            state.free_cells.Reset(config.CellCount());
+            for (int offset = 0; offset < config.start_length; ++offset)
+            {
+                Cell segment = config.ToCell(config.start_x + offset, config.start_y);
+
+                state.snake_position_queue.PushBack(segment);
+                state.snake_occupancy.Occupy(segment);
+                state.free_cells.Remove(segment);
+            }
+
+            SpawnFood();
+        }
+
+        bool SnakeSimulation::SpawnFood()
+        {
+            if (state.free_cells.Size() == 0)
+            {
+                return false;
+            }
+
+            Cell food_cell = state.free_cells.free_cells[UniformBelow(generator, state.free_cells.Size())];
+
+            state.free_cells.Remove(food_cell);
+            state.food_positions.push_back(food_cell);
+            state.snake_occupancy.PlaceFood(food_cell);
+
+            return true;
+        }
+
+        bool SnakeSimulation::IsTurn(InputDirection input) const
+        {
+            switch (state.current_movement_direction)
+            {
+            case MovementDirection::Left:
+            case MovementDirection::Right:
+                return input == InputDirection::Up || input == InputDirection::Down;
+            case MovementDirection::Up:
+            case MovementDirection::Down:
+                return input == InputDirection::Left || input == InputDirection::Right;
+            }
+            return false;
+        }
+
+        void SnakeSimulation::HandleInput(InputDirection input)
+        {
+            switch (state.current_movement_direction)
+            {
+            case MovementDirection::Left:
+            case MovementDirection::Right:
+            {
+                if (input == InputDirection::Up)
+                {
+                    state.current_movement_direction = MovementDirection::Up;
+                }
+                else if (input == InputDirection::Down)
+                {
+                    state.current_movement_direction = MovementDirection::Down;
+                }
+                break;
+            }
+            case MovementDirection::Up:
+            case MovementDirection::Down:
+            {
+                if (input == InputDirection::Left)
+                {
+                    state.current_movement_direction = MovementDirection::Left;
+                }
+                else if (input == InputDirection::Right)
+                {
+                    state.current_movement_direction = MovementDirection::Right;
+                }
+                break;
+            }
+            }
+        }
+
+        StepResult SnakeSimulation::Step(InputDirection input)
+        {
+            if (IsOver())
+            {
+                return StepResult::GameOver;
+            }
+
+            double tick_seconds = 1.0 / TickRate();
+
+            HandleInput(input);
+
+            int new_head_x = config.CellX(state.snake_position_queue.Front());
+            int new_head_y = config.CellY(state.snake_position_queue.Front());
+
+            switch (state.current_movement_direction)
+            {
+            case MovementDirection::Left:   new_head_x--; break;
+            case MovementDirection::Right:  new_head_x++; break;
+            case MovementDirection::Up:     new_head_y--; break;
+            case MovementDirection::Down:   new_head_y++; break;
+            }
+
+            // Check if new head is out of bounds or already covered by the snake:
+            if (config.IsOutOfBounds(new_head_x, new_head_y) || state.snake_occupancy.IsOccupied(config.ToCell(new_head_x, new_head_y)))
+            {
+                state.isDead = true;
+                return StepResult::Died;
+            }
+
+            Cell new_head_pos = config.ToCell(new_head_x, new_head_y);
+
+            // Check if new_head_pos holds food => snake is eating
+            bool is_eating = state.snake_occupancy.HasFood(new_head_pos);
+
+            state.snake_position_queue.PushFront(new_head_pos);
+            ++state.moves;
+            state.snake_occupancy.Occupy(new_head_pos);
+            if (state.free_cells.Contains(new_head_pos))
+            {
+                state.free_cells.Remove(new_head_pos);
+            }
+
+            if (is_eating)
+            {
+                // Swap the eaten food with the last one, the order of the food does not matter
+                auto eaten = std::find(state.food_positions.begin(), state.food_positions.end(), new_head_pos);
+                *eaten = state.food_positions.back();
+                state.food_positions.pop_back();
+                SpawnFood();
+            }
+            else
+            {
+                state.snake_occupancy.Free(state.snake_position_queue.Back());
+                state.free_cells.Insert(state.snake_position_queue.Back());
+                state.snake_position_queue.PopBack();
+            }
+
+            state.seconds_since_food_spawn += tick_seconds;
+            if (state.seconds_since_food_spawn >= config.food_spawn_interval_seconds)
+            {
+                SpawnFood();
+                state.seconds_since_food_spawn -= config.food_spawn_interval_seconds;
+            }
+
+            // The board is full once there is neither a free cell nor food left => player won
+            if (state.free_cells.Size() == 0 && state.food_positions.empty())
+            {
+                state.won = true;
+                return StepResult::Won;
+            }
+
+            return is_eating ? StepResult::Ate : StepResult::Moved;
+        }
+    } // namespace Snake
+} // namespace TerminalMinigames
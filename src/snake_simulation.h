@@ -0,0 +1,428 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "util/input_direction.h"
+#include "util/random.h"
+#include "util/ring_buffer.h"
+
+namespace TerminalMinigames
+{
+    namespace Snake
+    {
+        /**
+         * Enum listing all the avilable movement directions for the snake.
+         */
+        enum class MovementDirection
+        {
+            Left,
+            Right,
+            Up,
+            Down
+        };
+
+        /**
+         * Compact representation of a position on the board: the row-major index of a grid cell.
+         * The 2x4 block footprint a cell covers on the canvas is only derived when drawing (see DrawCell).
+         */
+        using Cell = std::uint32_t;
+
+        /**
+         * Structure defining the configuration of the Snake game.
+         */
+        struct SnakeConfig
+        {
+            /**
+             * Distance between the centers of two neighbouring cells on the canvas.
+             */
+            int movement_offset = 4;
+
+            /**
+             * Width of the canvas the board is drawn on.
+             */
+            int board_dimension_x = 200;
+            /**
+             * Height of the canvas.
+             */
+            int board_dimension_y = 100;
+            /**
+             * Min position on the x-axis to put a cell's center.
+             */
+            int min_x_dimension = 3;
+            /**
+             * Min position on the y-axis to put a cell's center.
+             */
+            int min_y_dimension = 3;
+            /**
+             * Max position on the x-axis to put a cell's center.
+             */
+            int max_x_dimension = 196;
+            /**
+             * Max position on the y-axis to put a cell's center.
+             */
+            int max_y_dimension = 96;
+
+            /**
+             * Floored x-coordinate of the center of the left-most cell on the canvas.
+             */
+            int grid_origin_x = 3;
+            /**
+             * Y-coordinate of the center of the top-most cell on the canvas.
+             */
+            int grid_origin_y = 5;
+
+            /**
+             * Cell coordinates of the snake's head at the start of a game.
+             */
+            int start_x = 11;
+            int start_y = 5;
+            /**
+             * Length of the snake at the start of a game. The body initially extends to the right of the head.
+             */
+            int start_length = 4;
+
+            /**
+             * Game time in seconds after which additional food is spawned even if the snake did not eat.
+             */
+            double food_spawn_interval_seconds = 10.5;
+
+            /**
+             * Ticks per second at the start of a game.
+             */
+            double tick_rate_initial = 2.0;
+            /**
+             * Increase of the tick rate per food eaten.
+             */
+            double tick_rate_increase_per_food = 0.25;
+            /**
+             * Upper bound of the tick rate.
+             */
+            double tick_rate_max = 8.0;
+
+            /**
+             * Number of cells along the x-axis that lie within the board's bounds.
+             */
+            int GridWidth() const
+            {
+                return (max_x_dimension - grid_origin_x) / movement_offset + 1;
+            }
+
+            /**
+             * Number of cells along the y-axis that lie within the board's bounds.
+             */
+            int GridHeight() const
+            {
+                return (max_y_dimension - grid_origin_y) / movement_offset + 1;
+            }
+
+            int CellCount() const
+            {
+                return GridWidth() * GridHeight();
+            }
+
+            /**
+             * Checks whether the given cell coordinates lie outside of the board.
+             */
+            bool IsOutOfBounds(int x, int y) const
+            {
+                return x < 0 || y < 0 || x >= GridWidth() || y >= GridHeight();
+            }
+
+            Cell ToCell(int x, int y) const
+            {
+                return static_cast<Cell>(y * GridWidth() + x);
+            }
+
+            int CellX(Cell cell) const
+            {
+                return static_cast<int>(cell) % GridWidth();
+            }
+
+            int CellY(Cell cell) const
+            {
+                return static_cast<int>(cell) / GridWidth();
+            }
+        };
+
+        /**
+         * Byte grid with one entry per cell the snake's head can move to.
+         * Allows constant time checks whether a cell is covered by the snake or holds food instead of scanning the whole
+         * body or all food.
+         */
+        struct OccupancyGrid
+        {
+            static constexpr std::uint8_t empty = 0;
+            static constexpr std::uint8_t snake = 1;
+            static constexpr std::uint8_t food = 2;
+
+            int width = 0;
+            int height = 0;
+
+            /**
+             * Row-major content of the cells, one of the values above per cell.
+             */
+            std::vector<std::uint8_t> cells;
+
+            /**
+             * Resizes the grid to the given dimensions and marks all cells as free.
+             *
+             * @param new_width Number of cells along the x-axis.
+             * @param new_height Number of cells along the y-axis.
+             */
+            void Resize(int new_width, int new_height)
+            {
+                width = new_width;
+                height = new_height;
+                cells.assign(static_cast<size_t>(width) * height, empty);
+            }
+
+            /**
+             * Whether the given cell is covered by the snake.
+             */
+            bool IsOccupied(Cell cell) const
+            {
+                return cells[cell] == snake;
+            }
+
+            bool HasFood(Cell cell) const
+            {
+                return cells[cell] == food;
+            }
+
+            /**
+             * Covers the given cell with the snake, replacing any food in it.
+             */
+            void Occupy(Cell cell)
+            {
+                cells[cell] = snake;
+            }
+
+            void PlaceFood(Cell cell)
+            {
+                cells[cell] = food;
+            }
+
+            void Free(Cell cell)
+            {
+                cells[cell] = empty;
+            }
+        };
+
+        /**
+         * Set of the cells that are neither covered by the snake nor by food.
+         * Stores the free cells densely together with each cell's position in the dense array,
+         * so cells can be inserted, removed and sampled uniformly in constant time.
+         */
+        struct FreeCellIndex
+        {
+            /**
+             * Dense array of the free cells.
+             */
+            std::vector<Cell> free_cells;
+            /**
+             * Position of each cell in free_cells or -1 if the cell is not free.
+             */
+            std::vector<int> positions;
+
+            /**
+             * Marks all cells of a grid with the given number of cells as free.
+             *
+             * @param cell_count Total number of cells on the board.
+             */
+            void Reset(int cell_count)
+            {
+                free_cells.resize(cell_count);
+                positions.resize(cell_count);
+                for (int cell = 0; cell < cell_count; ++cell)
+                {
+                    free_cells[cell] = static_cast<Cell>(cell);
+                    positions[cell] = cell;
+                }
+            }
+
+            bool Contains(Cell cell) const
+            {
+                return positions[cell] != -1;
+            }
+
+            size_t Size() const
+            {
+                return free_cells.size();
+            }
+
+            /**
+             * Removes the given cell by swapping it with the last free cell.
+             *
+             * @param cell Cell to remove. Must currently be free.
+             */
+            void Remove(Cell cell)
+            {
+                int position = positions[cell];
+                Cell last_cell = free_cells.back();
+
+                free_cells[position] = last_cell;
+                positions[last_cell] = position;
+
+                free_cells.pop_back();
+                positions[cell] = -1;
+            }
+
+            /**
+             * Adds the given cell to the set of free cells.
+             *
+             * @param cell Cell to add. Must currently not be free.
+             */
+            void Insert(Cell cell)
+            {
+                positions[cell] = static_cast<int>(free_cells.size());
+                free_cells.push_back(cell);
+            }
+        };
+
+        /**
+         * Struct containing all the information required for maintaining the current state of the game.
+         */
+        struct SnakeGameState
+        {
+            /**
+             * Flag whether the player died or not.
+             */
+            bool isDead = false;
+            /**
+             * Flag whether the snake covers the whole board, i.e. the player won.
+             */
+            bool won = false;
+            /**
+             * Ring buffer containing the cells covered by the snake, starting with its head.
+             * Sized to the number of cells on the board, so moving the snake never allocates.
+             */
+            RingBuffer<Cell> snake_position_queue;
+            /**
+             * Number of cells the head moved since the reset. The newest cells at the front of snake_position_queue
+             * are the ones the head moved to, so observers can catch up on the snake without comparing all of its cells.
+             */
+            std::uint64_t moves = 0;
+            /**
+             * Current movement direction of the snake.
+             */
+            MovementDirection current_movement_direction = MovementDirection::Left;
+            /**
+             * Cells with food for the snake, in no particular order. Reserved for the number of cells on the board,
+             * so spawning food never allocates; the food cells are also marked in snake_occupancy for lookups.
+             */
+            std::vector<Cell> food_positions;
+            /**
+             * Cells currently covered by the snake or holding food. Kept in sync with snake_position_queue and food_positions.
+             */
+            OccupancyGrid snake_occupancy;
+            /**
+             * Cells food can be spawned in. Kept in sync with snake_position_queue and food_positions.
+             */
+            FreeCellIndex free_cells;
+            /**
+             * Game time in seconds since food was last spawned by the spawn interval.
+             */
+            double seconds_since_food_spawn = 0.0;
+        };
+
+        /**
+         * Enum listing the outcomes of a single simulation step.
+         */
+        enum class StepResult
+        {
+            Moved,
+            Ate,
+            Died,
+            Won,
+            /**
+             * The game was already over before the step, nothing changed.
+             */
+            GameOver
+        };
+
+        /**
+         * Headless Snake simulation without any timing or UI.
+         * All randomness is drawn from a generator seeded with the given seed,
+         * so the same seed and sequence of inputs always produce the same game.
+         */
+        class SnakeSimulation
+        {
+        public:
+            SnakeSimulation(SnakeConfig config = {}, std::uint64_t seed = 0);
+
+            /**
+             * Resets the simulation to start a fresh game with the given seed.
+             *
+             * @param new_seed Seed for the food placement.
+             */
+            void Reset(std::uint64_t new_seed);
+
+            /**
+             * Advances the game by one tick, which lasts 1 / TickRate() seconds of game time.
+             *
+             * @param input Input received since the last tick or InputDirection::None.
+             * @returns Outcome of the step.
+             */
+            StepResult Step(InputDirection input);
+
+            /**
+             * Checks whether the given input would change the snake's movement direction in the next step.
+             * Inputs along the current axis of movement are no turns as the snake cannot reverse.
+             */
+            bool IsTurn(InputDirection input) const;
+
+            /**
+             * Returns the number of ticks per second the game should currently be stepped at.
+             * Starts at the configured initial rate and speeds up with every food eaten.
+             */
+            double TickRate() const
+            {
+                double food_eaten = static_cast<double>(state.snake_position_queue.Size()) - config.start_length;
+                return std::min(config.tick_rate_initial + food_eaten * config.tick_rate_increase_per_food, config.tick_rate_max);
+            }
+
+            const SnakeGameState& State() const
+            {
+                return state;
+            }
+
+            const SnakeConfig& Config() const
+            {
+                return config;
+            }
+
+            std::uint64_t Seed() const
+            {
+                return seed;
+            }
+
+            bool IsOver() const
+            {
+                return state.isDead || state.won;
+            }
+
+        private:
+            /**
+             * Spawns food in a cell chosen uniformly from the cells that are not yet covered by the snake or food.
+             *
+             * @returns Whether food was spawned, i.e. false if there is no free cell left.
+             */
+            bool SpawnFood();
+
+            /**
+             * Changes the movement direction according to the given input.
+             * Inputs along the current axis of movement are ignored as the snake cannot reverse.
+             *
+             * @param input Input to apply.
+             */
+            void HandleInput(InputDirection input);
+
+            SnakeConfig config;
+            std::uint64_t seed;
+            Xoshiro256StarStar generator;
+            SnakeGameState state;
+        };
+    } // namespace Snake
+} // namespace TerminalMinigames
@@ -0,0 +1,335 @@
+#include <csignal>
+#include <optional>
+#include <string_view>
+
+#include "ftxui/dom/elements.hpp"
+
+#include "terminal_screen.h"
+#include "util/profiler.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#define TERMINAL_MINIGAMES_POSIX_TERMINAL
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <termios.h>
+#include <unistd.h>
+#endif
+
+namespace TerminalMinigames
+{
+#ifdef TERMINAL_MINIGAMES_POSIX_TERMINAL
+    namespace
+    {
+        /**
+         * Write end of the running loop's wake pipe, for the signal handlers.
+         */
+        volatile std::sig_atomic_t signal_wake_fd = -1;
+        volatile std::sig_atomic_t resized = 0;
+        volatile std::sig_atomic_t interrupted = 0;
+
+        termios original_terminal_settings;
+        struct sigaction previous_resize_action;
+        struct sigaction previous_interrupt_action;
+        struct sigaction previous_terminate_action;
+
+        void Wake(int fd)
+        {
+            if (fd >= 0)
+            {
+                char byte = 0;
+                [[maybe_unused]] auto written = write(fd, &byte, 1);
+            }
+        }
+
+        void HandleResize(int)
+        {
+            resized = 1;
+            Wake(signal_wake_fd);
+        }
+
+        void HandleInterrupt(int)
+        {
+            interrupted = 1;
+            Wake(signal_wake_fd);
+        }
+
+        /**
+         * Decodes the key at the start of the given input.
+         *
+         * @param input Bytes read from the keyboard. Must not be empty.
+         * @param length Receives the number of bytes the key takes up. Zero if the input does not hold a complete key yet.
+         * @returns Event of the key, if it is one the components handle.
+         */
+        std::optional<ftxui::Event> ParseKey(std::string_view input, size_t& length)
+        {
+            auto first = static_cast<unsigned char>(input[0]);
+            length = 1;
+
+            if (first == 0x1B)
+            {
+                // A lone escape is the escape key, terminals send the bytes of a sequence together
+                if (input.size() == 1 || (input[1] != '[' && input[1] != 'O'))
+                {
+                    return ftxui::Event::Escape;
+                }
+
+                // Parameters of a control sequence end with a byte between '@' and '~'
+                size_t end = 2;
+                while (end < input.size() && (input[end] < '@' || input[end] > '~'))
+                {
+                    ++end;
+                }
+                if (end == input.size())
+                {
+                    length = 0;
+                    return std::nullopt;
+                }
+                length = end + 1;
+
+                if (end == 2)
+                {
+                    switch (input[end])
+                    {
+                    case 'A': return ftxui::Event::ArrowUp;
+                    case 'B': return ftxui::Event::ArrowDown;
+                    case 'C': return ftxui::Event::ArrowRight;
+                    case 'D': return ftxui::Event::ArrowLeft;
+                    case 'Z': return ftxui::Event::TabReverse;
+                    }
+                }
+                return std::nullopt;
+            }
+
+            switch (first)
+            {
+            case '\r':
+            case '\n':
+                return ftxui::Event::Return;
+            case '\t':
+                return ftxui::Event::Tab;
+            case 0x08:
+            case 0x7F:
+                return ftxui::Event::Backspace;
+            }
+            if (first < 0x20)
+            {
+                return std::nullopt;
+            }
+
+            // UTF-8 encoded character
+            size_t character_length = first < 0x80 ? 1 : first >= 0xF0 ? 4 : first >= 0xE0 ? 3 : first >= 0xC0 ? 2 : 1;
+            if (input.size() < character_length)
+            {
+                length = 0;
+                return std::nullopt;
+            }
+            length = character_length;
+            return ftxui::Event::Character(std::string(input.substr(0, character_length)));
+        }
+    }
+#endif
+
+    TerminalScreen::TerminalScreen(std::ostream& output) : output(output), writer(output), frame(0, 0)
+    {
+#ifdef TERMINAL_MINIGAMES_POSIX_TERMINAL
+        // Created up front so threads posting events never see the pipe being opened or closed
+        if (pipe(wake_pipe) == 0)
+        {
+            fcntl(wake_pipe[0], F_SETFL, O_NONBLOCK);
+            fcntl(wake_pipe[1], F_SETFL, O_NONBLOCK);
+        }
+#endif
+    }
+
+    TerminalScreen::~TerminalScreen()
+    {
+#ifdef TERMINAL_MINIGAMES_POSIX_TERMINAL
+        close(wake_pipe[0]);
+        close(wake_pipe[1]);
+#endif
+    }
+
+    bool TerminalScreen::IsSupported()
+    {
+#ifdef TERMINAL_MINIGAMES_POSIX_TERMINAL
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    void TerminalScreen::Loop(ftxui::Component component)
+    {
+#ifdef TERMINAL_MINIGAMES_POSIX_TERMINAL
+        Install();
+        while (!exit_requested)
+        {
+            Draw(component);
+            WaitForInput();
+            HandleInput(component);
+            HandlePostedEvents(component);
+        }
+        Uninstall();
+#endif
+    }
+
+    void TerminalScreen::PostEvent(ftxui::Event event)
+    {
+        {
+            std::lock_guard lock(posted_events_mutex);
+            posted_events.push_back(std::move(event));
+        }
+#ifdef TERMINAL_MINIGAMES_POSIX_TERMINAL
+        Wake(wake_pipe[1]);
+#endif
+    }
+
+    void TerminalScreen::Exit()
+    {
+        exit_requested = true;
+#ifdef TERMINAL_MINIGAMES_POSIX_TERMINAL
+        Wake(wake_pipe[1]);
+#endif
+    }
+
+#ifdef TERMINAL_MINIGAMES_POSIX_TERMINAL
+    void TerminalScreen::Install()
+    {
+        exit_requested = false;
+        resized = 1;
+        interrupted = 0;
+
+        signal_wake_fd = wake_pipe[1];
+
+        // Keep ISIG so Ctrl+C still interrupts, but read keys one by one without echoing them
+        tcgetattr(STDIN_FILENO, &original_terminal_settings);
+        termios raw_settings = original_terminal_settings;
+        raw_settings.c_lflag &= ~(ICANON | ECHO);
+        raw_settings.c_cc[VMIN] = 1;
+        raw_settings.c_cc[VTIME] = 0;
+        tcsetattr(STDIN_FILENO, TCSANOW, &raw_settings);
+
+        struct sigaction resize_action = {};
+        resize_action.sa_handler = HandleResize;
+        sigaction(SIGWINCH, &resize_action, &previous_resize_action);
+
+        struct sigaction interrupt_action = {};
+        interrupt_action.sa_handler = HandleInterrupt;
+        sigaction(SIGINT, &interrupt_action, &previous_interrupt_action);
+        sigaction(SIGTERM, &interrupt_action, &previous_terminate_action);
+
+        // Switch to the alternate screen and hide the cursor
+        output << "\x1B[?1049h\x1B[?25l" << std::flush;
+    }
+
+    void TerminalScreen::Uninstall()
+    {
+        output << "\x1B[0m\x1B[?25h\x1B[?1049l" << std::flush;
+
+        sigaction(SIGWINCH, &previous_resize_action, nullptr);
+        sigaction(SIGINT, &previous_interrupt_action, nullptr);
+        sigaction(SIGTERM, &previous_terminate_action, nullptr);
+
+        tcsetattr(STDIN_FILENO, TCSANOW, &original_terminal_settings);
+
+        signal_wake_fd = -1;
+
+        writer.Invalidate();
+    }
+
+    void TerminalScreen::Draw(ftxui::Component& component)
+    {
+        if (resized)
+        {
+            resized = 0;
+
+            winsize size = {};
+            if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &size) != 0 || size.ws_col == 0 || size.ws_row == 0)
+            {
+                size.ws_col = 80;
+                size.ws_row = 24;
+            }
+            frame = ftxui::Screen(size.ws_col, size.ws_row);
+        }
+
+        frame.Clear();
+        auto document = component->Render();
+        {
+            ProfileScope profile(ProfilePhase::ScreenLayout);
+            ftxui::Render(frame, document);
+        }
+
+        ProfileScope profile(ProfilePhase::TerminalOutput);
+        writer.Write(frame);
+    }
+
+    void TerminalScreen::WaitForInput()
+    {
+        pollfd descriptors[2] = {
+            { STDIN_FILENO, POLLIN, 0 },
+            { wake_pipe[0], POLLIN, 0 }
+        };
+        poll(descriptors, 2, -1);
+    }
+
+    void TerminalScreen::HandleInput(ftxui::Component& component)
+    {
+        // Empty the wake pipe, the events it signalled are handled afterwards
+        char wake_bytes[64];
+        while (read(wake_pipe[0], wake_bytes, sizeof(wake_bytes)) > 0)
+        {
+        }
+        if (interrupted)
+        {
+            exit_requested = true;
+        }
+
+        pollfd keyboard = { STDIN_FILENO, POLLIN, 0 };
+        if (poll(&keyboard, 1, 0) <= 0)
+        {
+            return;
+        }
+
+        char bytes[256];
+        auto count = read(STDIN_FILENO, bytes, sizeof(bytes));
+        if (count <= 0)
+        {
+            return;
+        }
+        pending_input.append(bytes, static_cast<size_t>(count));
+
+        size_t position = 0;
+        while (position < pending_input.size())
+        {
+            size_t length = 0;
+            auto event = ParseKey(std::string_view(pending_input).substr(position), length);
+            if (length == 0)
+            {
+                break;
+            }
+            position += length;
+
+            if (event)
+            {
+                component->OnEvent(*event);
+            }
+        }
+        pending_input.erase(0, position);
+    }
+
+    void TerminalScreen::HandlePostedEvents(ftxui::Component& component)
+    {
+        {
+            std::lock_guard lock(posted_events_mutex);
+            std::swap(posted_events, handled_events);
+        }
+
+        for (const ftxui::Event& event : handled_events)
+        {
+            component->OnEvent(event);
+        }
+        handled_events.clear();
+    }
+#endif
+}
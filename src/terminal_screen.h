@@ -0,0 +1,91 @@
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "ftxui/component/component.hpp"
+#include "ftxui/component/event.hpp"
+#include "ftxui/screen/screen.hpp"
+
+#include "util/diff_frame_writer.h"
+
+namespace TerminalMinigames
+{
+    /**
+     * Fullscreen terminal loop that draws through a DiffFrameWriter, as an alternative to ftxui::ScreenInteractive.
+     * ScreenInteractive sends the whole screen for every event. This loop reads the keyboard itself, handles all pending
+     * input and posted events in one go and then only sends the cells that changed, which matters on slow links like SSH.
+     * Only available on POSIX terminals.
+     */
+    class TerminalScreen
+    {
+    public:
+        explicit TerminalScreen(std::ostream& output);
+        ~TerminalScreen();
+
+        TerminalScreen(const TerminalScreen&) = delete;
+        TerminalScreen& operator=(const TerminalScreen&) = delete;
+
+        /**
+         * Whether the loop can run on this platform.
+         */
+        static bool IsSupported();
+
+        /**
+         * Shows the given component in the alternate screen and handles its events until the loop is exited.
+         */
+        void Loop(ftxui::Component component);
+
+        /**
+         * Queues the given event for the component and wakes up the loop to draw a new frame. Can be called from any thread.
+         */
+        void PostEvent(ftxui::Event event);
+
+        /**
+         * Makes the loop return after the current frame. Can be called from any thread.
+         */
+        void Exit();
+
+        /**
+         * Writer of the frames, for its output statistics.
+         */
+        const DiffFrameWriter& Writer() const
+        {
+            return writer;
+        }
+
+    private:
+        void Install();
+        void Uninstall();
+        void Draw(ftxui::Component& component);
+        void WaitForInput();
+        void HandleInput(ftxui::Component& component);
+        void HandlePostedEvents(ftxui::Component& component);
+
+        std::ostream& output;
+        DiffFrameWriter writer;
+        ftxui::Screen frame;
+
+        std::atomic<bool> exit_requested = false;
+
+        std::mutex posted_events_mutex;
+        std::vector<ftxui::Event> posted_events;
+        /**
+         * Events taken from the posted events, swapped with them so handling events does not allocate.
+         */
+        std::vector<ftxui::Event> handled_events;
+
+        /**
+         * Bytes read from the keyboard that do not form a complete key yet.
+         */
+        std::string pending_input;
+
+        /**
+         * Pipe to wake up the loop while it waits for input. Written to by PostEvent, Exit and the signal handlers.
+         */
+        int wake_pipe[2] = { -1, -1 };
+    };
+}
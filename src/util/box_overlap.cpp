@@ -0,0 +1,218 @@
+#include <bit>
+
+#include "box_overlap.h"
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define TERMINAL_MINIGAMES_X86_64
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define TARGET_AVX2
+#else
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+namespace TerminalMinigames
+{
+    namespace
+    {
+        /**
+         * Number of doubles in the narrowest vector register used by a kernel.
+         */
+        constexpr size_t minimum_vector_lanes = 2;
+
+        /**
+         * Query box the boxes are tested against.
+         */
+        struct QueryBox
+        {
+            double min_x;
+            double min_y;
+            double max_x;
+            double max_y;
+        };
+
+        /**
+         * Tests a single box. Uses the same comparisons as the vectorized kernels.
+         */
+        bool BoxOverlaps(const BoxArrays& boxes, std::uint32_t index, const QueryBox& query)
+        {
+            return !(boxes.left[index] > query.max_x || boxes.top[index] > query.max_y
+                || query.min_x > boxes.right[index] || query.min_y > boxes.bottom[index]);
+        }
+
+        size_t FilterScalar(const BoxArrays& boxes, std::span<const std::uint32_t> indices, size_t first,
+            const QueryBox& query, std::uint32_t* overlapping, size_t count)
+        {
+            for (size_t i = first; i < indices.size(); ++i)
+            {
+                if (BoxOverlaps(boxes, indices[i], query))
+                {
+                    overlapping[count++] = indices[i];
+                }
+            }
+            return count;
+        }
+
+#ifdef TERMINAL_MINIGAMES_X86_64
+        /**
+         * Appends the indices of the lanes whose bit is not set in the given mask of boxes lying outside.
+         */
+        size_t AppendInsideLanes(int outside_mask, int lane_mask, const std::uint32_t* indices, std::uint32_t* overlapping, size_t count)
+        {
+            unsigned inside = static_cast<unsigned>(~outside_mask & lane_mask);
+            while (inside != 0)
+            {
+                overlapping[count++] = indices[std::countr_zero(inside)];
+                inside &= inside - 1;
+            }
+            return count;
+        }
+
+        size_t FilterSse2(const BoxArrays& boxes, std::span<const std::uint32_t> indices,
+            const QueryBox& query, std::uint32_t* overlapping)
+        {
+            const __m128d min_x = _mm_set1_pd(query.min_x);
+            const __m128d min_y = _mm_set1_pd(query.min_y);
+            const __m128d max_x = _mm_set1_pd(query.max_x);
+            const __m128d max_y = _mm_set1_pd(query.max_y);
+
+            size_t count = 0;
+            size_t i = 0;
+            for (; i + 2 <= indices.size(); i += 2)
+            {
+                std::uint32_t a = indices[i];
+                std::uint32_t b = indices[i + 1];
+
+                __m128d left = _mm_set_pd(boxes.left[b], boxes.left[a]);
+                __m128d top = _mm_set_pd(boxes.top[b], boxes.top[a]);
+                __m128d right = _mm_set_pd(boxes.right[b], boxes.right[a]);
+                __m128d bottom = _mm_set_pd(boxes.bottom[b], boxes.bottom[a]);
+
+                __m128d outside = _mm_or_pd(
+                    _mm_or_pd(_mm_cmpgt_pd(left, max_x), _mm_cmpgt_pd(top, max_y)),
+                    _mm_or_pd(_mm_cmpgt_pd(min_x, right), _mm_cmpgt_pd(min_y, bottom)));
+
+                count = AppendInsideLanes(_mm_movemask_pd(outside), 0x3, indices.data() + i, overlapping, count);
+            }
+
+            return FilterScalar(boxes, indices, i, query, overlapping, count);
+        }
+
+        TARGET_AVX2 size_t FilterAvx2(const BoxArrays& boxes, std::span<const std::uint32_t> indices,
+            const QueryBox& query, std::uint32_t* overlapping)
+        {
+            const __m256d min_x = _mm256_set1_pd(query.min_x);
+            const __m256d min_y = _mm256_set1_pd(query.min_y);
+            const __m256d max_x = _mm256_set1_pd(query.max_x);
+            const __m256d max_y = _mm256_set1_pd(query.max_y);
+
+            size_t count = 0;
+            size_t i = 0;
+            for (; i + 4 <= indices.size(); i += 4)
+            {
+                // Scalar loads instead of vgatherdpd, which is microcoded and very slow on CPUs with the gather data sampling mitigation
+                std::uint32_t a = indices[i];
+                std::uint32_t b = indices[i + 1];
+                std::uint32_t c = indices[i + 2];
+                std::uint32_t d = indices[i + 3];
+
+                __m256d left = _mm256_set_pd(boxes.left[d], boxes.left[c], boxes.left[b], boxes.left[a]);
+                __m256d top = _mm256_set_pd(boxes.top[d], boxes.top[c], boxes.top[b], boxes.top[a]);
+                __m256d right = _mm256_set_pd(boxes.right[d], boxes.right[c], boxes.right[b], boxes.right[a]);
+                __m256d bottom = _mm256_set_pd(boxes.bottom[d], boxes.bottom[c], boxes.bottom[b], boxes.bottom[a]);
+
+                __m256d outside = _mm256_or_pd(
+                    _mm256_or_pd(_mm256_cmp_pd(left, max_x, _CMP_GT_OQ), _mm256_cmp_pd(top, max_y, _CMP_GT_OQ)),
+                    _mm256_or_pd(_mm256_cmp_pd(min_x, right, _CMP_GT_OQ), _mm256_cmp_pd(min_y, bottom, _CMP_GT_OQ)));
+
+                count = AppendInsideLanes(_mm256_movemask_pd(outside), 0xF, indices.data() + i, overlapping, count);
+            }
+
+            // Compilers may skip the implicit vzeroupper before the tail call into non-VEX code, which stalls every following SSE instruction
+            _mm256_zeroupper();
+
+            return FilterScalar(boxes, indices, i, query, overlapping, count);
+        }
+
+        bool CpuSupportsAvx2()
+        {
+#if defined(_MSC_VER)
+            int info[4];
+            __cpuid(info, 0);
+            if (info[0] < 7)
+            {
+                return false;
+            }
+
+            // AVX2 also requires the OS to save the upper halves of the ymm registers
+            __cpuid(info, 1);
+            bool os_saves_ymm = (info[2] & (1 << 27)) != 0 && (info[2] & (1 << 28)) != 0 && (_xgetbv(0) & 0x6) == 0x6;
+            if (!os_saves_ymm)
+            {
+                return false;
+            }
+
+            __cpuidex(info, 7, 0);
+            return (info[1] & (1 << 5)) != 0;
+#else
+            return __builtin_cpu_supports("avx2");
+#endif
+        }
+#endif
+    }
+
+    bool IsOverlapKernelSupported(OverlapKernel kernel)
+    {
+        switch (kernel)
+        {
+        case OverlapKernel::Scalar:
+            return true;
+#ifdef TERMINAL_MINIGAMES_X86_64
+        case OverlapKernel::Sse2:
+            return true; // part of every x86-64 CPU
+        case OverlapKernel::Avx2:
+        {
+            static const bool avx2 = CpuSupportsAvx2();
+            return avx2;
+        }
+#endif
+        default:
+            return false;
+        }
+    }
+
+    OverlapKernel BestOverlapKernel()
+    {
+        static const OverlapKernel best =
+            IsOverlapKernelSupported(OverlapKernel::Avx2) ? OverlapKernel::Avx2 :
+            IsOverlapKernelSupported(OverlapKernel::Sse2) ? OverlapKernel::Sse2 :
+            OverlapKernel::Scalar;
+        return best;
+    }
+
+    size_t FilterOverlappingBoxes(OverlapKernel kernel, const BoxArrays& boxes, std::span<const std::uint32_t> indices,
+        double min_x, double min_y, double max_x, double max_y, std::uint32_t* overlapping)
+    {
+        QueryBox query = { min_x, min_y, max_x, max_y };
+
+        // Lists shorter than two vectors are faster to test one by one than to pack into registers
+        if (indices.size() < 2 * minimum_vector_lanes)
+        {
+            kernel = OverlapKernel::Scalar;
+        }
+
+        switch (kernel)
+        {
+#ifdef TERMINAL_MINIGAMES_X86_64
+        case OverlapKernel::Sse2:
+            return FilterSse2(boxes, indices, query, overlapping);
+        case OverlapKernel::Avx2:
+            return FilterAvx2(boxes, indices, query, overlapping);
+#endif
+        default:
+            return FilterScalar(boxes, indices, 0, query, overlapping, 0);
+        }
+    }
+}
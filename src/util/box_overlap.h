@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <string>
+
+namespace TerminalMinigames
+{
+    /**
+     * Implementation used to test a ball's bounding box against many boxes at once.
+     */
+    enum class OverlapKernel
+    {
+        Scalar,
+        Sse2,
+        Avx2
+    };
+
+    inline const std::string ToString(OverlapKernel kernel)
+    {
+        switch (kernel)
+        {
+        case OverlapKernel::Scalar: return "Scalar";
+        case OverlapKernel::Sse2:   return "SSE2";
+        case OverlapKernel::Avx2:   return "AVX2";
+        }
+        return "Scalar";
+    }
+
+    /**
+     * Returns the fastest kernel supported by the CPU the program is running on.
+     * The CPU is only queried on the first call.
+     */
+    OverlapKernel BestOverlapKernel();
+
+    /**
+     * Checks whether the given kernel can be run on the CPU the program is running on.
+     */
+    bool IsOverlapKernelSupported(OverlapKernel kernel);
+
+    /**
+     * Axis-aligned boxes stored as one array per edge coordinate, so a kernel can load the same edge of several boxes at once.
+     */
+    struct BoxArrays
+    {
+        const double* left;
+        const double* top;
+        const double* right;
+        const double* bottom;
+    };
+
+    /**
+     * Collects the boxes overlapped by a query box. Touching edges count as overlap.
+     * All kernels use the same comparisons in double precision, so they return exactly the same boxes.
+     *
+     * @param kernel Kernel to use. Must be supported by the CPU.
+     * @param boxes Boxes to index into.
+     * @param indices Indices of the boxes to test.
+     * @param min_x Left edge of the query box.
+     * @param min_y Top edge of the query box.
+     * @param max_x Right edge of the query box.
+     * @param max_y Bottom edge of the query box.
+     * @param overlapping Output array with room for at least indices.size() elements. Receives the overlapping indices in their input order.
+     * @returns Number of overlapping boxes written to the output array.
+     */
+    size_t FilterOverlappingBoxes(OverlapKernel kernel, const BoxArrays& boxes, std::span<const std::uint32_t> indices,
+        double min_x, double min_y, double max_x, double max_y, std::uint32_t* overlapping);
+}
@@ -0,0 +1,161 @@
+#include "coroutine_scheduler.h"
+
+namespace TerminalMinigames
+{
+    CoroutineScheduler::CoroutineScheduler(WakeFunction wake) : wake(std::move(wake))
+    {
+    }
+
+    CoroutineScheduler::~CoroutineScheduler()
+    {
+        Stop();
+        for (auto& [id, handle] : tasks)
+        {
+            handle.destroy();
+        }
+    }
+
+    void CoroutineScheduler::Start()
+    {
+        waker_thread = std::jthread([this](std::stop_token stop) { RunWaker(stop); });
+    }
+
+    void CoroutineScheduler::Stop()
+    {
+        waker_thread.request_stop();
+        if (waker_thread.joinable())
+        {
+            waker_thread.join();
+        }
+    }
+
+    TaskId CoroutineScheduler::Spawn(Task task)
+    {
+        Task::Handle handle = std::exchange(task.handle, {});
+        TaskId id = ++last_id;
+        handle.promise().scheduler = this;
+        handle.promise().id = id;
+        tasks.emplace(id, handle);
+
+        Resume(id);
+        return id;
+    }
+
+    void CoroutineScheduler::Cancel(TaskId id)
+    {
+        auto task = tasks.find(id);
+        if (task == tasks.end())
+        {
+            return;
+        }
+
+        Task::Handle handle = task->second;
+        tasks.erase(task);
+        handle.destroy();
+    }
+
+    void CoroutineScheduler::RunDue()
+    {
+        auto now = Clock::now();
+        while (!timers.empty() && timers.top().deadline <= now)
+        {
+            ready.push_back(timers.top().task);
+            timers.pop();
+        }
+
+        if (!running)
+        {
+            RunReady();
+        }
+    }
+
+    void CoroutineScheduler::Resume(TaskId id)
+    {
+        ready.push_back(id);
+        if (!running)
+        {
+            RunReady();
+        }
+    }
+
+    void CoroutineScheduler::AddTimer(Clock::time_point deadline, TaskId task)
+    {
+        timers.push({ deadline, task });
+    }
+
+    void CoroutineScheduler::RunReady()
+    {
+        running = true;
+        while (!ready.empty())
+        {
+            TaskId id = ready.front();
+            ready.pop_front();
+
+            auto task = tasks.find(id);
+            if (task == tasks.end())
+            {
+                continue;
+            }
+
+            Task::Handle handle = task->second;
+            handle.resume();
+            if (!handle.done())
+            {
+                continue;
+            }
+
+            // The task may have spawned others while it ran, which invalidates the iterator
+            tasks.erase(id);
+            std::exception_ptr exception = handle.promise().exception;
+            handle.destroy();
+            if (exception)
+            {
+                running = false;
+                PublishWakeDeadline();
+                std::rethrow_exception(exception);
+            }
+        }
+        running = false;
+
+        PublishWakeDeadline();
+    }
+
+    void CoroutineScheduler::PublishWakeDeadline()
+    {
+        Clock::time_point deadline = timers.empty() ? Clock::time_point::max() : timers.top().deadline;
+
+        {
+            std::lock_guard lock(waker_mutex);
+            if (deadline == wake_deadline)
+            {
+                return;
+            }
+            wake_deadline = deadline;
+        }
+        waker_condition.notify_one();
+    }
+
+    void CoroutineScheduler::RunWaker(std::stop_token stop)
+    {
+        std::unique_lock lock(waker_mutex);
+        while (!stop.stop_requested())
+        {
+            Clock::time_point deadline = wake_deadline;
+            auto deadline_changed = [this, deadline] { return wake_deadline != deadline; };
+
+            bool changed = deadline == Clock::time_point::max()
+                ? waker_condition.wait(lock, stop, deadline_changed)
+                : waker_condition.wait_until(lock, stop, deadline, deadline_changed);
+            if (changed || stop.stop_requested())
+            {
+                continue;
+            }
+
+            // The event loop publishes the next deadline once it ran the due tasks
+            wake_deadline = Clock::time_point::max();
+            lock.unlock();
+            wake();
+            lock.lock();
+        }
+    }
+}
@@ -0,0 +1,330 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <coroutine>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <queue>
+#include <stop_token>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace TerminalMinigames
+{
+    class CoroutineScheduler;
+
+    /**
+     * Identifies a task spawned on a CoroutineScheduler. Ids are never reused and zero never identifies a task.
+     */
+    using TaskId = std::uint64_t;
+
+    /**
+     * Coroutine run as a task by a CoroutineScheduler. Does nothing until it is spawned. The scheduler destroys it when
+     * it returns or is cancelled, which runs the destructors of its local variables at the point where it was suspended.
+     */
+    class Task
+    {
+    public:
+        struct promise_type
+        {
+            CoroutineScheduler* scheduler = nullptr;
+            TaskId id = 0;
+            std::exception_ptr exception;
+
+            Task get_return_object()
+            {
+                return Task(std::coroutine_handle<promise_type>::from_promise(*this));
+            }
+
+            std::suspend_always initial_suspend() noexcept
+            {
+                return {};
+            }
+
+            std::suspend_always final_suspend() noexcept
+            {
+                return {};
+            }
+
+            void return_void()
+            {
+            }
+
+            void unhandled_exception()
+            {
+                exception = std::current_exception();
+            }
+        };
+
+        using Handle = std::coroutine_handle<promise_type>;
+
+        Task(Task&& other) noexcept : handle(std::exchange(other.handle, {}))
+        {
+        }
+
+        Task(const Task&) = delete;
+        Task& operator=(const Task&) = delete;
+        Task& operator=(Task&&) = delete;
+
+        ~Task()
+        {
+            if (handle)
+            {
+                handle.destroy();
+            }
+        }
+
+    private:
+        friend class CoroutineScheduler;
+
+        explicit Task(Handle handle) : handle(handle)
+        {
+        }
+
+        Handle handle;
+    };
+
+    /**
+     * Runs tasks cooperatively on the thread of the UI event loop, so the state they share with the UI needs no locks.
+     * Tasks suspend themselves by awaiting a timer or an EventChannel and are resumed by RunDue() once their timer
+     * expired, or right away when a value is pushed to the channel they wait for.
+     * A single waker thread, started once for the whole application, sleeps until the earliest timer of all tasks and
+     * then calls the wake function, which must make the event loop call RunDue(). Apart from Start() and Stop(),
+     * everything must be called from the event loop's thread.
+     */
+    class CoroutineScheduler
+    {
+    public:
+        using Clock = std::chrono::steady_clock;
+        /**
+         * Makes the event loop call RunDue(). Called from the waker thread.
+         */
+        using WakeFunction = std::function<void()>;
+
+        /**
+         * Suspends the awaiting task until the given time. Does not suspend if the time already passed.
+         */
+        class SleepAwaiter
+        {
+        public:
+            SleepAwaiter(CoroutineScheduler& scheduler, Clock::time_point deadline) : scheduler(scheduler), deadline(deadline)
+            {
+            }
+
+            bool await_ready() const
+            {
+                return deadline <= Clock::now();
+            }
+
+            void await_suspend(Task::Handle handle)
+            {
+                scheduler.AddTimer(deadline, handle.promise().id);
+            }
+
+            void await_resume() const
+            {
+            }
+
+        private:
+            CoroutineScheduler& scheduler;
+            Clock::time_point deadline;
+        };
+
+        explicit CoroutineScheduler(WakeFunction wake);
+        /**
+         * Stops the waker thread and destroys all tasks that did not return yet.
+         */
+        ~CoroutineScheduler();
+
+        CoroutineScheduler(const CoroutineScheduler&) = delete;
+        CoroutineScheduler& operator=(const CoroutineScheduler&) = delete;
+
+        /**
+         * Starts the waker thread.
+         */
+        void Start();
+
+        /**
+         * Stops and joins the waker thread. Expired timers are only run by RunDue() calls the event loop makes anyway.
+         */
+        void Stop();
+
+        /**
+         * Adds the given task and runs it until it first suspends.
+         *
+         * @returns Id to cancel the task with.
+         */
+        TaskId Spawn(Task task);
+
+        /**
+         * Destroys the task with the given id if it did not return yet. Must not be called by the task itself.
+         */
+        void Cancel(TaskId id);
+
+        /**
+         * Whether the task with the given id did neither return nor get cancelled yet.
+         */
+        bool IsAlive(TaskId id) const
+        {
+            return tasks.contains(id);
+        }
+
+        /**
+         * Resumes all tasks whose timers expired.
+         * Rethrows the exception a resumed task ended with, after destroying that task.
+         */
+        void RunDue();
+
+        /**
+         * Resumes the task with the given id, immediately unless a task is running, in which case it is resumed once
+         * the running one suspends. Ignored if the task returned or was cancelled.
+         */
+        void Resume(TaskId id);
+
+        SleepAwaiter SleepUntil(Clock::time_point deadline)
+        {
+            return { *this, deadline };
+        }
+
+        SleepAwaiter SleepFor(Clock::duration duration)
+        {
+            return { *this, Clock::now() + duration };
+        }
+
+    private:
+        struct Timer
+        {
+            Clock::time_point deadline;
+            TaskId task;
+
+            bool operator>(const Timer& other) const
+            {
+                return deadline > other.deadline;
+            }
+        };
+
+        void AddTimer(Clock::time_point deadline, TaskId task);
+        void RunReady();
+        /**
+         * Hands the deadline of the earliest timer to the waker thread.
+         */
+        void PublishWakeDeadline();
+        void RunWaker(std::stop_token stop);
+
+        WakeFunction wake;
+
+        std::unordered_map<TaskId, Task::Handle> tasks;
+        TaskId last_id = 0;
+        /**
+         * Timers of suspended tasks, earliest first. Timers of cancelled tasks are dropped when they expire.
+         */
+        std::priority_queue<Timer, std::vector<Timer>, std::greater<>> timers;
+        /**
+         * Tasks to resume in order. Tasks that were cancelled in the meantime are skipped.
+         */
+        std::deque<TaskId> ready;
+        bool running = false;
+
+        std::mutex waker_mutex;
+        std::condition_variable_any waker_condition;
+        /**
+         * Deadline the waker thread sleeps until, the maximum time point if there is none.
+         */
+        Clock::time_point wake_deadline = Clock::time_point::max();
+        std::jthread waker_thread;
+    };
+
+    /**
+     * Bounded queue of values handed to a task on the event loop's thread, e.g. the inputs caught for a game.
+     * A task can take the queued values without waiting or await the next one. Only one task may take values from a channel.
+     *
+     * @tparam T Element type.
+     * @tparam Capacity Maximum number of queued values.
+     */
+    template <typename T, size_t Capacity>
+    class EventChannel
+    {
+    public:
+        /**
+         * Appends the given value and resumes the task waiting for it, if any.
+         *
+         * @returns Whether the value was added, i.e. false if the channel is full.
+         */
+        bool Push(const T& value)
+        {
+            if (values.size() == Capacity)
+            {
+                return false;
+            }
+            values.push_back(value);
+
+            if (waiter)
+            {
+                auto [scheduler, id] = *std::exchange(waiter, std::nullopt);
+                scheduler->Resume(id);
+            }
+            return true;
+        }
+
+        /**
+         * Removes and returns the oldest value without waiting.
+         */
+        std::optional<T> TryReceive()
+        {
+            if (values.empty())
+            {
+                return std::nullopt;
+            }
+
+            T value = values.front();
+            values.pop_front();
+            return value;
+        }
+
+        /**
+         * Drops all queued values.
+         */
+        void Clear()
+        {
+            values.clear();
+        }
+
+        /**
+         * Awaitable that removes and returns the oldest value, suspending the awaiting task until there is one.
+         */
+        auto Receive()
+        {
+            struct ReceiveAwaiter
+            {
+                EventChannel& channel;
+
+                bool await_ready() const
+                {
+                    return !channel.values.empty();
+                }
+
+                void await_suspend(Task::Handle handle)
+                {
+                    channel.waiter = { handle.promise().scheduler, handle.promise().id };
+                }
+
+                T await_resume()
+                {
+                    return *channel.TryReceive();
+                }
+            };
+            return ReceiveAwaiter{ *this };
+        }
+
+    private:
+        std::deque<T> values;
+        std::optional<std::pair<CoroutineScheduler*, TaskId>> waiter;
+    };
+}
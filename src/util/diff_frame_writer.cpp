@@ -0,0 +1,254 @@
+#include <charconv>
+#include <chrono>
+
+#include "diff_frame_writer.h"
+
+namespace TerminalMinigames
+{
+    namespace
+    {
+        /**
+         * Number of unchanged cells up to which a run of changed cells is continued by writing the unchanged cells again.
+         * Up to this length that is no longer than the escape sequence to move the cursor past them.
+         */
+        constexpr int max_rewritten_gap = 3;
+
+        bool HasSameStyle(const ftxui::Pixel& a, const ftxui::Pixel& b)
+        {
+            return a.bold == b.bold && a.dim == b.dim && a.underlined == b.underlined && a.blink == b.blink && a.inverted == b.inverted
+                && a.foreground_color == b.foreground_color && a.background_color == b.background_color;
+        }
+
+        bool IsSameCell(const ftxui::Pixel& a, const ftxui::Pixel& b)
+        {
+            return a.character == b.character && HasSameStyle(a, b);
+        }
+
+        void AppendNumber(std::string& buffer, int value)
+        {
+            char digits[16];
+            auto result = std::to_chars(digits, digits + sizeof(digits), value);
+            buffer.append(digits, result.ptr);
+        }
+
+        size_t DigitCount(int value)
+        {
+            size_t count = 1;
+            for (; value >= 10; value /= 10)
+            {
+                ++count;
+            }
+            return count;
+        }
+    }
+
+    const FrameStats& DiffFrameWriter::Write(ftxui::Screen& screen)
+    {
+        buffer.clear();
+        last_frame = {};
+
+        if (screen.dimx() != width || screen.dimy() != height)
+        {
+            Clear(screen.dimx(), screen.dimy());
+        }
+
+        for (int y = 0; y < height; ++y)
+        {
+            int x = 0;
+            while (x < width)
+            {
+                if (IsSameCell(screen.PixelAt(x, y), shown[static_cast<size_t>(y) * width + x]))
+                {
+                    ++x;
+                    continue;
+                }
+
+                // Extend the run over the following changed cells and short gaps of unchanged ones between them
+                int last_changed = x;
+                for (int next = x + 1; next < width && next - last_changed <= max_rewritten_gap + 1; ++next)
+                {
+                    if (!IsSameCell(screen.PixelAt(next, y), shown[static_cast<size_t>(y) * width + next]))
+                    {
+                        last_changed = next;
+                    }
+                }
+
+                WriteRun(screen, y, x, last_changed + 1);
+                x = last_changed + 1;
+            }
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        if (!buffer.empty())
+        {
+            output.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+            output.flush();
+        }
+        last_frame.flush_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        last_frame.bytes_written = buffer.size();
+
+        totals.bytes_written += last_frame.bytes_written;
+        totals.cells_changed += last_frame.cells_changed;
+        totals.flush_ms += last_frame.flush_ms;
+        ++frames;
+
+        return last_frame;
+    }
+
+    void DiffFrameWriter::Clear(int new_width, int new_height)
+    {
+        width = new_width;
+        height = new_height;
+        shown.assign(static_cast<size_t>(width) * height, ftxui::Pixel());
+
+        // Reset the attributes first so the terminal clears to the default background
+        buffer += "\x1B[0m\x1B[2J";
+        style = ftxui::Pixel();
+        cursor_x = -1;
+        cursor_y = -1;
+    }
+
+    void DiffFrameWriter::WriteRun(ftxui::Screen& screen, int y, int begin, int end)
+    {
+        for (int x = begin; x < end; ++x)
+        {
+            const ftxui::Pixel& pixel = screen.PixelAt(x, y);
+            ftxui::Pixel& shown_pixel = shown[static_cast<size_t>(y) * width + x];
+            if (!IsSameCell(pixel, shown_pixel))
+            {
+                shown_pixel = pixel;
+                ++last_frame.cells_changed;
+            }
+
+            // An empty cell is covered by the wide character before it
+            if (pixel.character.empty())
+            {
+                continue;
+            }
+
+            MoveCursor(x, y);
+            UpdateStyle(pixel);
+            buffer += pixel.character;
+
+            cursor_x = x + 1;
+            if (cursor_x < width && screen.PixelAt(cursor_x, y).character.empty())
+            {
+                ++cursor_x;
+            }
+
+            // After writing the last column the cursor waits to wrap, so its position cannot be relied on
+            if (cursor_x >= width)
+            {
+                cursor_x = -1;
+                cursor_y = -1;
+            }
+        }
+    }
+
+    void DiffFrameWriter::MoveCursor(int x, int y)
+    {
+        if (cursor_y == y && cursor_x == x)
+        {
+            return;
+        }
+
+        size_t absolute_length = 4 + DigitCount(y + 1) + DigitCount(x + 1);
+
+        if (cursor_y == y && cursor_x >= 0)
+        {
+            int distance = x > cursor_x ? x - cursor_x : cursor_x - x;
+            size_t relative_length = distance == 1 ? 3 : 3 + DigitCount(distance);
+            if (relative_length <= absolute_length)
+            {
+                buffer += "\x1B[";
+                if (distance != 1)
+                {
+                    AppendNumber(buffer, distance);
+                }
+                buffer += x > cursor_x ? 'C' : 'D';
+                cursor_x = x;
+                return;
+            }
+        }
+        else if (cursor_y >= 0 && y == cursor_y + 1 && x == 0)
+        {
+            buffer += "\r\n";
+            cursor_x = x;
+            cursor_y = y;
+            return;
+        }
+
+        buffer += "\x1B[";
+        AppendNumber(buffer, y + 1);
+        buffer += ';';
+        AppendNumber(buffer, x + 1);
+        buffer += 'H';
+        cursor_x = x;
+        cursor_y = y;
+    }
+
+    void DiffFrameWriter::UpdateStyle(const ftxui::Pixel& pixel)
+    {
+        if (HasSameStyle(pixel, style))
+        {
+            return;
+        }
+
+        // All changes are combined into a single SGR sequence
+        buffer += "\x1B[";
+        size_t parameters_start = buffer.size();
+        auto add_parameter = [&](const std::string& parameter)
+            {
+                if (buffer.size() != parameters_start)
+                {
+                    buffer += ';';
+                }
+                buffer += parameter;
+            };
+
+        // Bold and dim are both turned off by the same parameter
+        if ((style.bold && !pixel.bold) || (style.dim && !pixel.dim))
+        {
+            add_parameter("22");
+            style.bold = false;
+            style.dim = false;
+        }
+        if (pixel.bold && !style.bold)
+        {
+            add_parameter("1");
+        }
+        if (pixel.dim && !style.dim)
+        {
+            add_parameter("2");
+        }
+        if (pixel.underlined != style.underlined)
+        {
+            add_parameter(pixel.underlined ? "4" : "24");
+        }
+        if (pixel.blink != style.blink)
+        {
+            add_parameter(pixel.blink ? "5" : "25");
+        }
+        if (pixel.inverted != style.inverted)
+        {
+            add_parameter(pixel.inverted ? "7" : "27");
+        }
+        if (pixel.foreground_color != style.foreground_color)
+        {
+            add_parameter(pixel.foreground_color.Print(false));
+        }
+        if (pixel.background_color != style.background_color)
+        {
+            add_parameter(pixel.background_color.Print(true));
+        }
+        buffer += 'm';
+
+        style.bold = pixel.bold;
+        style.dim = pixel.dim;
+        style.underlined = pixel.underlined;
+        style.blink = pixel.blink;
+        style.inverted = pixel.inverted;
+        style.foreground_color = pixel.foreground_color;
+        style.background_color = pixel.background_color;
+    }
+}
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "ftxui/screen/screen.hpp"
+
+namespace TerminalMinigames
+{
+    /**
+     * Output statistics of written frames.
+     */
+    struct FrameStats
+    {
+        /**
+         * Bytes of escape sequences and characters sent to the terminal.
+         */
+        size_t bytes_written = 0;
+        /**
+         * Cells that differed from the previous frame.
+         */
+        size_t cells_changed = 0;
+        /**
+         * Time spent writing and flushing the bytes to the output stream.
+         */
+        double flush_ms = 0.0;
+    };
+
+    /**
+     * Writes rendered screens to a terminal by sending only the cells that changed since the previous frame.
+     * Changed cells are written in runs, the cursor is moved between runs with the shortest escape sequence available
+     * and colors and attributes are only sent when they differ from the previously written cell.
+     */
+    class DiffFrameWriter
+    {
+    public:
+        explicit DiffFrameWriter(std::ostream& output) : output(output)
+        {
+        }
+
+        /**
+         * Writes the changes between the given screen and the previously written one and flushes the output.
+         * Clears the terminal and writes every non-blank cell if the screen's size changed or the writer was invalidated.
+         *
+         * @returns Statistics of the written frame.
+         */
+        const FrameStats& Write(ftxui::Screen& screen);
+
+        /**
+         * Forgets the previously written frame, e.g. after the terminal was cleared or resized by someone else.
+         */
+        void Invalidate()
+        {
+            width = 0;
+            height = 0;
+        }
+
+        /**
+         * Statistics of the last written frame.
+         */
+        const FrameStats& LastFrame() const
+        {
+            return last_frame;
+        }
+
+        /**
+         * Statistics summed over all written frames.
+         */
+        const FrameStats& Totals() const
+        {
+            return totals;
+        }
+
+        size_t Frames() const
+        {
+            return frames;
+        }
+
+    private:
+        void Clear(int new_width, int new_height);
+        void MoveCursor(int x, int y);
+        void UpdateStyle(const ftxui::Pixel& pixel);
+        void WriteRun(ftxui::Screen& screen, int y, int begin, int end);
+
+        std::ostream& output;
+        /**
+         * Bytes of the frame being written. Kept between frames so writing a frame does not allocate.
+         */
+        std::string buffer;
+
+        /**
+         * Cells as they are currently shown on the terminal.
+         */
+        std::vector<ftxui::Pixel> shown;
+        int width = 0;
+        int height = 0;
+
+        /**
+         * Position of the terminal's cursor. Negative if unknown, e.g. after writing the last column of a row.
+         */
+        int cursor_x = -1;
+        int cursor_y = -1;
+        /**
+         * Attributes and colors the terminal currently writes with.
+         */
+        ftxui::Pixel style;
+
+        FrameStats last_frame;
+        FrameStats totals;
+        size_t frames = 0;
+    };
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <chrono>
+
+namespace TerminalMinigames
+{
+    /**
+     * Simulation clock that turns elapsed real time into a whole number of fixed-length steps.
+     * Time that does not add up to a full step is carried over to the next update, so the simulation
+     * always advances by the same step length no matter how irregularly it is woken up.
+     */
+    class FixedTimestep
+    {
+    public:
+        using Duration = std::chrono::steady_clock::duration;
+
+        /**
+         * @param steps_per_second Rate at which the simulation is stepped.
+         * @param max_backlog Maximum amount of time to catch up on after a stall. Any time beyond is dropped in whole steps.
+         */
+        FixedTimestep(double steps_per_second, Duration max_backlog = std::chrono::milliseconds(250))
+            : step(std::chrono::duration_cast<Duration>(std::chrono::duration<double>(1.0 / steps_per_second))),
+            max_backlog(max_backlog)
+        {
+        }
+
+        /**
+         * Adds the given elapsed time and returns the number of steps to run for it.
+         */
+        int Advance(Duration elapsed)
+        {
+            accumulator += elapsed;
+            if (accumulator > max_backlog)
+            {
+                auto dropped_steps = (accumulator - max_backlog + step - Duration(1)) / step;
+                accumulator -= dropped_steps * step;
+            }
+
+            int steps = static_cast<int>(accumulator / step);
+            accumulator -= steps * step;
+            return steps;
+        }
+
+        /**
+         * Drops all accumulated time.
+         */
+        void Reset()
+        {
+            accumulator = Duration::zero();
+        }
+
+        /**
+         * Length of a step in seconds.
+         */
+        double StepSeconds() const
+        {
+            return std::chrono::duration<double>(step).count();
+        }
+
+        /**
+         * Fraction of a step accumulated since the last whole step, between 0 and 1.
+         * Used to interpolate between the last two simulated states when drawing.
+         */
+        double Alpha() const
+        {
+            return std::chrono::duration<double>(accumulator) / std::chrono::duration<double>(step);
+        }
+
+    private:
+        Duration step;
+        Duration max_backlog;
+        Duration accumulator = Duration::zero();
+    };
+}
@@ -0,0 +1,189 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <stop_token>
+#include <thread>
+
+#include "stoppable_sleep.h"
+
+namespace TerminalMinigames
+{
+    /**
+     * Counters of a FramePacer.
+     */
+    struct FramePacerStats
+    {
+        /**
+         * Frames handed to the UI thread to be drawn.
+         */
+        std::uint64_t frames_posted = 0;
+        /**
+         * Redraw requests merged into a frame that was already requested.
+         */
+        std::uint64_t requests_coalesced = 0;
+        /**
+         * Frame slots skipped because the UI thread was still drawing the previous frame.
+         */
+        std::uint64_t frames_dropped = 0;
+    };
+
+    /**
+     * Turns redraw requests from any number of threads into frames for the UI thread, at most one per frame period.
+     * Requests arriving while a frame is already pending are merged into it, and no new frame is posted while the UI
+     * thread is still drawing the previous one, so the UI thread never falls behind a backlog of redraws. The threads
+     * requesting redraws are never blocked, so simulations keep running at their own rate while frames are skipped.
+     */
+    class FramePacer
+    {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        /**
+         * Function making the UI thread draw a frame. Called from the pacer's thread.
+         */
+        using PostFrameFunction = std::function<void()>;
+
+        /**
+         * @param max_fps Maximum number of frames posted per second.
+         * @param post_frame Function making the UI thread draw a frame. It must call FrameDrawn() once drawn.
+         */
+        FramePacer(int max_fps, PostFrameFunction post_frame)
+            : frame_period(std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / std::max(max_fps, 1)))),
+              post_frame(std::move(post_frame))
+        {
+        }
+
+        /**
+         * Starts the pacer's thread, which posts the requested frames.
+         */
+        void Start()
+        {
+            pacer_thread = std::jthread([this](std::stop_token stop) { Run(stop); });
+        }
+
+        /**
+         * Stops and joins the pacer's thread. Requests made afterwards are not posted.
+         */
+        void Stop()
+        {
+            pacer_thread.request_stop();
+            if (pacer_thread.joinable())
+            {
+                pacer_thread.join();
+            }
+        }
+
+        /**
+         * Requests a frame to be drawn. Can be called from any thread and never blocks on the UI thread.
+         */
+        void RequestFrame()
+        {
+            {
+                std::lock_guard lock(mutex);
+                if (frame_requested)
+                {
+                    requests_coalesced.fetch_add(1, std::memory_order_relaxed);
+                    return;
+                }
+                frame_requested = true;
+            }
+            wake.notify_one();
+        }
+
+        /**
+         * Signals that the UI thread drew a frame. Must be called by the UI thread after every draw.
+         */
+        void FrameDrawn()
+        {
+            {
+                std::lock_guard lock(mutex);
+                if (!frame_in_flight)
+                {
+                    return;
+                }
+                frame_in_flight = false;
+
+                // Every whole frame period the frame took beyond its own is a frame that could not be shown
+                auto draw_time = Clock::now() - frame_posted_at;
+                if (draw_time > frame_period)
+                {
+                    auto skipped_slots = (draw_time - Clock::duration(1)) / frame_period;
+                    frames_dropped.fetch_add(static_cast<std::uint64_t>(skipped_slots), std::memory_order_relaxed);
+                }
+            }
+            wake.notify_one();
+        }
+
+        FramePacerStats Stats() const
+        {
+            return {
+                frames_posted.load(std::memory_order_relaxed),
+                requests_coalesced.load(std::memory_order_relaxed),
+                frames_dropped.load(std::memory_order_relaxed)
+            };
+        }
+
+    private:
+        void Run(std::stop_token stop)
+        {
+            auto next_frame = Clock::now();
+
+            std::unique_lock lock(mutex);
+            while (true)
+            {
+                if (!wake.wait(lock, stop, [this] { return frame_requested && !frame_in_flight; }))
+                {
+                    return;
+                }
+
+                // Requests arriving until the frame's slot are merged into it
+                if (Clock::now() < next_frame)
+                {
+                    lock.unlock();
+                    if (!SleepUntil(stop, next_frame))
+                    {
+                        return;
+                    }
+                    lock.lock();
+                }
+
+                frame_requested = false;
+                frame_in_flight = true;
+                frame_posted_at = Clock::now();
+                next_frame = std::max(next_frame + frame_period, frame_posted_at);
+
+                lock.unlock();
+                frames_posted.fetch_add(1, std::memory_order_relaxed);
+                post_frame();
+                lock.lock();
+            }
+        }
+
+        const Clock::duration frame_period;
+        PostFrameFunction post_frame;
+
+        std::mutex mutex;
+        std::condition_variable_any wake;
+        /**
+         * Whether a frame was requested since the last frame was posted.
+         */
+        bool frame_requested = false;
+        /**
+         * Whether the last posted frame was not drawn yet.
+         */
+        bool frame_in_flight = false;
+        Clock::time_point frame_posted_at;
+
+        std::atomic<std::uint64_t> frames_posted = 0;
+        std::atomic<std::uint64_t> requests_coalesced = 0;
+        std::atomic<std::uint64_t> frames_dropped = 0;
+
+        std::jthread pacer_thread;
+    };
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <chrono>
+
+namespace TerminalMinigames
+{
+    /**
+     * Enum listing all available input directions.
+     */
+    enum class InputDirection
+    {
+        Left,
+        Right,
+        Up,
+        Down,
+        None
+    };
+
+    /**
+     * Input caught by the UI thread together with the time it was caught at.
+     */
+    struct InputEvent
+    {
+        InputDirection direction = InputDirection::None;
+        std::chrono::steady_clock::time_point timestamp;
+    };
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <algorithm>
+
+namespace TerminalMinigames
+{
+    /**
+     * Running statistics of a latency, in milliseconds.
+     */
+    struct LatencyStats
+    {
+        double last_ms = 0.0;
+        /**
+         * Exponential moving average over the recent samples.
+         */
+        double average_ms = 0.0;
+        double max_ms = 0.0;
+
+        void Record(double latency_ms)
+        {
+            last_ms = latency_ms;
+            average_ms += (latency_ms - average_ms) / 16.0;
+            max_ms = std::max(max_ms, latency_ms);
+        }
+    };
+}
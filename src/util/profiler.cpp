@@ -0,0 +1,197 @@
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <format>
+
+#include "profiler.h"
+
+namespace TerminalMinigames
+{
+    namespace
+    {
+        double ToMilliseconds(std::uint64_t duration_ns)
+        {
+            return static_cast<double>(duration_ns) / 1'000'000.0;
+        }
+    }
+
+    const char* ToString(ProfilePhase phase)
+    {
+        switch (phase)
+        {
+        case ProfilePhase::SimulationStep: return "Simulation step";
+        case ProfilePhase::BoardCanvas: return "Board canvas";
+        case ProfilePhase::StatusText: return "Status text";
+        case ProfilePhase::SceneRender: return "Scene render";
+        case ProfilePhase::ScreenLayout: return "Screen layout";
+        case ProfilePhase::TerminalOutput: return "Terminal output";
+        default: return "Unknown";
+        }
+    }
+
+    size_t DurationHistogram::BucketIndex(std::uint64_t value)
+    {
+        // Values below two whole powers of sub-buckets are counted exactly, larger ones lose their lowest bits
+        if (value < 2 * sub_bucket_count)
+        {
+            return static_cast<size_t>(value);
+        }
+        unsigned shift = static_cast<unsigned>(std::bit_width(value)) - sub_bucket_bits - 1;
+        return static_cast<size_t>(shift * sub_bucket_count + (value >> shift));
+    }
+
+    std::uint64_t DurationHistogram::BucketHighestValue(size_t index)
+    {
+        if (index < 2 * sub_bucket_count)
+        {
+            return index;
+        }
+        std::uint64_t shift = index / sub_bucket_count - 1;
+        std::uint64_t mantissa = index - shift * sub_bucket_count;
+        return (mantissa << shift) + (std::uint64_t(1) << shift) - 1;
+    }
+
+    void DurationHistogram::Record(std::uint64_t duration_ns)
+    {
+        duration_ns = std::min(duration_ns, (std::uint64_t(1) << max_value_bits) - 1);
+        ++buckets[BucketIndex(duration_ns)];
+        ++count;
+        max = std::max(max, duration_ns);
+    }
+
+    std::uint64_t DurationHistogram::Percentile(double fraction) const
+    {
+        if (count == 0)
+        {
+            return 0;
+        }
+
+        auto target = std::max<std::uint64_t>(1, static_cast<std::uint64_t>(std::ceil(fraction * static_cast<double>(count))));
+        std::uint64_t cumulative = 0;
+        for (size_t index = 0; index < bucket_count; ++index)
+        {
+            cumulative += buckets[index];
+            if (cumulative >= target)
+            {
+                return std::min(BucketHighestValue(index), max);
+            }
+        }
+        return max;
+    }
+
+    void DurationHistogram::WritePercentiles(std::ostream& output) const
+    {
+        output << std::format("{:>12} {:>14} {:>10} {:>14}\n\n", "Value", "Percentile", "TotalCount", "1/(1-Percentile)");
+
+        std::uint64_t cumulative = 0;
+        double sum_ms = 0.0;
+        for (size_t index = 0; index < bucket_count; ++index)
+        {
+            if (buckets[index] == 0)
+            {
+                continue;
+            }
+            cumulative += buckets[index];
+
+            double value_ms = ToMilliseconds(std::min(BucketHighestValue(index), max));
+            sum_ms += value_ms * static_cast<double>(buckets[index]);
+
+            double percentile = static_cast<double>(cumulative) / static_cast<double>(count);
+            if (cumulative < count)
+            {
+                output << std::format("{:12.6f} {:14.12f} {:10} {:14.2f}\n", value_ms, percentile, cumulative, 1.0 / (1.0 - percentile));
+            }
+            else
+            {
+                output << std::format("{:12.6f} {:14.12f} {:10}\n", value_ms, percentile, cumulative);
+            }
+        }
+
+        double mean_ms = count > 0 ? sum_ms / static_cast<double>(count) : 0.0;
+        output << std::format("#[Mean    = {:12.6f}, Max         = {:12.6f}]\n", mean_ms, ToMilliseconds(max));
+        output << std::format("#[Buckets = {:12}, SubBuckets  = {:12}, Total count = {}]\n", bucket_count, sub_bucket_count, count);
+    }
+
+    Profiler& Profiler::Instance()
+    {
+        static Profiler profiler;
+        return profiler;
+    }
+
+    void Profiler::Record(ProfilePhase phase, Clock::duration duration)
+    {
+        Sample sample;
+        sample.phase = phase;
+        sample.duration_ns = static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count());
+
+        if (!ThreadLocalRing().samples.Push(sample))
+        {
+            dropped_samples.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    Profiler::ThreadRing& Profiler::ThreadLocalRing()
+    {
+        // Hands the ring back when the thread finishes
+        struct RingLease
+        {
+            ThreadRing* ring = nullptr;
+
+            ~RingLease()
+            {
+                if (ring)
+                {
+                    Profiler::Instance().ReleaseRing(*ring);
+                }
+            }
+        };
+        thread_local RingLease lease;
+
+        if (!lease.ring)
+        {
+            std::lock_guard lock(rings_mutex);
+            auto free_ring = std::find_if(rings.begin(), rings.end(), [](const auto& ring) { return !ring->in_use; });
+            if (free_ring == rings.end())
+            {
+                rings.push_back(std::make_unique<ThreadRing>());
+                free_ring = rings.end() - 1;
+            }
+            (*free_ring)->in_use = true;
+            lease.ring = free_ring->get();
+        }
+        return *lease.ring;
+    }
+
+    void Profiler::ReleaseRing(ThreadRing& ring)
+    {
+        std::lock_guard lock(rings_mutex);
+        ring.in_use = false;
+    }
+
+    void Profiler::Collect()
+    {
+        std::lock_guard lock(rings_mutex);
+        for (const auto& ring : rings)
+        {
+            while (auto sample = ring->samples.Pop())
+            {
+                histograms[static_cast<size_t>(sample->phase)].Record(sample->duration_ns);
+            }
+        }
+    }
+
+    void Profiler::WriteHistograms(std::ostream& output) const
+    {
+        for (size_t phase = 0; phase < profile_phase_count; ++phase)
+        {
+            if (histograms[phase].Count() == 0)
+            {
+                continue;
+            }
+            output << "# " << ToString(static_cast<ProfilePhase>(phase)) << " (ms)\n";
+            histograms[phase].WritePercentiles(output);
+            output << '\n';
+        }
+        output << "# Dropped samples: " << DroppedSamples() << '\n';
+    }
+}
@@ -0,0 +1,224 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <vector>
+
+#include "spsc_queue.h"
+
+namespace TerminalMinigames
+{
+    /**
+     * Parts of a frame that are timed by the profiler.
+     */
+    enum class ProfilePhase : std::uint8_t
+    {
+        /**
+         * One step of a game's simulation in its update task, including collision handling.
+         */
+        SimulationStep,
+        /**
+         * Updating a game's board canvas from the latest snapshot.
+         */
+        BoardCanvas,
+        /**
+         * Formatting a game's status texts.
+         */
+        StatusText,
+        /**
+         * Rendering the active scene's components into elements.
+         */
+        SceneRender,
+        /**
+         * Laying out and drawing the elements into the frame's cells.
+         */
+        ScreenLayout,
+        /**
+         * Diffing the frame and flushing it to the terminal.
+         */
+        TerminalOutput,
+        Count
+    };
+
+    constexpr size_t profile_phase_count = static_cast<size_t>(ProfilePhase::Count);
+
+    const char* ToString(ProfilePhase phase);
+
+    /**
+     * Histogram of durations in nanoseconds with buckets of logarithmically growing width, like an HDR histogram.
+     * Each power of two is split into 32 linear sub-buckets, so every recorded value is kept with a precision of about 3%.
+     */
+    class DurationHistogram
+    {
+    public:
+        void Record(std::uint64_t duration_ns);
+
+        /**
+         * Smallest duration that at least the given fraction of the recorded durations do not exceed, within the precision
+         * of the buckets.
+         *
+         * @param fraction Between 0 and 1, e.g. 0.99 for the 99th percentile.
+         */
+        std::uint64_t Percentile(double fraction) const;
+
+        std::uint64_t Count() const
+        {
+            return count;
+        }
+
+        std::uint64_t Max() const
+        {
+            return max;
+        }
+
+        /**
+         * Writes the percentile distribution in the text format of HdrHistogram, with values in milliseconds.
+         */
+        void WritePercentiles(std::ostream& output) const;
+
+    private:
+        static constexpr unsigned sub_bucket_bits = 5;
+        static constexpr std::uint64_t sub_bucket_count = 1u << sub_bucket_bits;
+        /**
+         * Durations are clamped to 2^40 ns, about 18 minutes.
+         */
+        static constexpr unsigned max_value_bits = 40;
+        static constexpr size_t bucket_count = (max_value_bits - sub_bucket_bits + 1) * sub_bucket_count;
+
+        static size_t BucketIndex(std::uint64_t value);
+        /**
+         * Largest value that falls into the bucket with the given index.
+         */
+        static std::uint64_t BucketHighestValue(size_t index);
+
+        std::array<std::uint64_t, bucket_count> buckets{};
+        std::uint64_t count = 0;
+        std::uint64_t max = 0;
+    };
+
+    /**
+     * Collects the durations of the profiled phases from all threads.
+     * Every thread records into its own lock-free ring buffer, so timing a phase never waits for another thread. The
+     * UI thread regularly moves the recorded durations into one histogram per phase.
+     * Nothing is recorded while the profiler is disabled, which keeps the timers' cost to a single atomic load.
+     */
+    class Profiler
+    {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        static Profiler& Instance();
+
+        void SetEnabled(bool enable)
+        {
+            enabled.store(enable, std::memory_order_relaxed);
+        }
+
+        bool IsEnabled() const
+        {
+            return enabled.load(std::memory_order_relaxed);
+        }
+
+        /**
+         * Records a duration of the given phase into the calling thread's ring buffer.
+         * Dropped if the ring buffer is full because the durations were not collected in time.
+         */
+        void Record(ProfilePhase phase, Clock::duration duration);
+
+        /**
+         * Moves the durations recorded by all threads into the histograms. Must only be called from one thread.
+         */
+        void Collect();
+
+        /**
+         * Histogram of the given phase's durations collected so far. Only to be used by the thread calling Collect().
+         */
+        const DurationHistogram& Histogram(ProfilePhase phase) const
+        {
+            return histograms[static_cast<size_t>(phase)];
+        }
+
+        /**
+         * Number of durations lost because a thread's ring buffer was full.
+         */
+        std::uint64_t DroppedSamples() const
+        {
+            return dropped_samples.load(std::memory_order_relaxed);
+        }
+
+        /**
+         * Writes the histograms of all phases that recorded durations.
+         */
+        void WriteHistograms(std::ostream& output) const;
+
+    private:
+        struct Sample
+        {
+            ProfilePhase phase = ProfilePhase::SimulationStep;
+            std::uint64_t duration_ns = 0;
+        };
+
+        struct ThreadRing
+        {
+            SpscQueue<Sample, 4096> samples;
+            /**
+             * Whether a running thread records into the ring. Rings of finished threads are reused by new threads.
+             */
+            bool in_use = false;
+        };
+
+        /**
+         * Returns the ring of the calling thread, taking a free one on the thread's first call.
+         */
+        ThreadRing& ThreadLocalRing();
+        void ReleaseRing(ThreadRing& ring);
+
+        std::atomic<bool> enabled = false;
+        std::atomic<std::uint64_t> dropped_samples = 0;
+
+        /**
+         * Guards the list of rings, which only changes when threads record for the first time or finish.
+         */
+        std::mutex rings_mutex;
+        std::vector<std::unique_ptr<ThreadRing>> rings;
+
+        std::array<DurationHistogram, profile_phase_count> histograms;
+    };
+
+    /**
+     * Records the time from its construction until its destruction as a duration of the given phase.
+     */
+    class ProfileScope
+    {
+    public:
+        explicit ProfileScope(ProfilePhase phase) : phase(phase), active(Profiler::Instance().IsEnabled())
+        {
+            if (active)
+            {
+                start = Profiler::Clock::now();
+            }
+        }
+
+        ~ProfileScope()
+        {
+            if (active)
+            {
+                Profiler::Instance().Record(phase, Profiler::Clock::now() - start);
+            }
+        }
+
+        ProfileScope(const ProfileScope&) = delete;
+        ProfileScope& operator=(const ProfileScope&) = delete;
+
+    private:
+        ProfilePhase phase;
+        bool active;
+        Profiler::Clock::time_point start;
+    };
+}
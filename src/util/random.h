@@ -0,0 +1,177 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <limits>
+#include <random>
+
+namespace TerminalMinigames
+{
+    /**
+     * SplitMix64 generator. Every seed, including zero, yields a well-mixed sequence, which makes it the recommended way
+     * to expand a single 64-bit seed into the state of a larger generator or into further seeds.
+     */
+    class SplitMix64
+    {
+    public:
+        explicit SplitMix64(std::uint64_t seed) : state(seed)
+        {
+        }
+
+        std::uint64_t Next()
+        {
+            std::uint64_t z = (state += 0x9e3779b97f4a7c15);
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+            return z ^ (z >> 31);
+        }
+
+    private:
+        std::uint64_t state;
+    };
+
+    /**
+     * xoshiro256** generator by Blackman and Vigna: 32 bytes of state, a period of 2^256 - 1 and a few cycles per number.
+     * Satisfies UniformRandomBitGenerator, so it works with the standard distributions, but bounded integers are best
+     * drawn with UniformBelow(). Not thread-safe; each thread or simulation should own a generator seeded with its own
+     * seed, e.g. one derived from a common seed with NextGameSeed().
+     */
+    class Xoshiro256StarStar
+    {
+    public:
+        using result_type = std::uint64_t;
+
+        /**
+         * Seeds the generator's state with the output of a SplitMix64 generator seeded with the given seed.
+         */
+        explicit Xoshiro256StarStar(std::uint64_t seed = 0)
+        {
+            Seed(seed);
+        }
+
+        void Seed(std::uint64_t seed)
+        {
+            SplitMix64 expander(seed);
+            for (auto& word : state)
+            {
+                word = expander.Next();
+            }
+        }
+
+        static constexpr result_type min()
+        {
+            return 0;
+        }
+
+        static constexpr result_type max()
+        {
+            return std::numeric_limits<result_type>::max();
+        }
+
+        result_type operator()()
+        {
+            const std::uint64_t result = std::rotl(state[1] * 5, 7) * 9;
+            const std::uint64_t shifted = state[1] << 17;
+
+            state[2] ^= state[0];
+            state[3] ^= state[1];
+            state[1] ^= state[2];
+            state[0] ^= state[3];
+            state[2] ^= shifted;
+            state[3] = std::rotl(state[3], 45);
+
+            return result;
+        }
+
+    private:
+        std::array<std::uint64_t, 4> state;
+    };
+
+    /**
+     * Seed of the game played after the game with the given seed. A run's games are seeded one after another from the
+     * seed of its first game, and every game's generator is seeded from its own 64-bit seed rather than split off a
+     * common generator, so any game can be played again by passing the seed shown for it.
+     */
+    inline std::uint64_t NextGameSeed(std::uint64_t seed)
+    {
+        return SplitMix64(seed).Next();
+    }
+
+    /**
+     * Full 128-bit product of the given numbers.
+     *
+     * @param low Set to the low 64 bits of the product.
+     * @returns High 64 bits of the product.
+     */
+    inline std::uint64_t MultiplyWide(std::uint64_t a, std::uint64_t b, std::uint64_t& low)
+    {
+#if defined(__SIZEOF_INT128__)
+        __extension__ typedef unsigned __int128 Product;
+        Product product = static_cast<Product>(a) * b;
+        low = static_cast<std::uint64_t>(product);
+        return static_cast<std::uint64_t>(product >> 64);
+#else
+        std::uint64_t a_low = a & 0xffffffff;
+        std::uint64_t a_high = a >> 32;
+        std::uint64_t b_low = b & 0xffffffff;
+        std::uint64_t b_high = b >> 32;
+
+        std::uint64_t low_low = a_low * b_low;
+        std::uint64_t low_high = a_low * b_high;
+        std::uint64_t high_low = a_high * b_low;
+        std::uint64_t middle = (low_low >> 32) + (low_high & 0xffffffff) + (high_low & 0xffffffff);
+
+        low = (middle << 32) | (low_low & 0xffffffff);
+        return a_high * b_high + (low_high >> 32) + (high_low >> 32) + (middle >> 32);
+#endif
+    }
+
+    /**
+     * Draws an integer uniformly from [0, bound) without bias, using Lemire's multiply-and-reject method.
+     * The number drawn is scaled to the range by a multiplication, and only the few draws that would make some results
+     * more likely than others are rejected, so a division is only needed in the rare case that a draw is close to one.
+     *
+     * @param generator Generator returning uniformly distributed 64-bit numbers.
+     * @param bound Number of possible results. Must be greater than zero.
+     */
+    template <typename Generator>
+    std::uint64_t UniformBelow(Generator& generator, std::uint64_t bound)
+    {
+        static_assert(Generator::min() == 0 && Generator::max() == std::numeric_limits<std::uint64_t>::max(),
+            "The generator must return full 64-bit numbers");
+
+        std::uint64_t low;
+        std::uint64_t result = MultiplyWide(generator(), bound, low);
+        if (low < bound)
+        {
+            // 2^64 mod bound: the number of low products that would be over-represented
+            std::uint64_t threshold = (0 - bound) % bound;
+            while (low < threshold)
+            {
+                result = MultiplyWide(generator(), bound, low);
+            }
+        }
+        return result;
+    }
+
+    /**
+     * Draws an integer uniformly from [min, max] without bias.
+     */
+    template <typename Generator>
+    std::int64_t UniformInRange(Generator& generator, std::int64_t min, std::int64_t max)
+    {
+        std::uint64_t span = static_cast<std::uint64_t>(max) - static_cast<std::uint64_t>(min);
+        std::uint64_t offset = span == std::numeric_limits<std::uint64_t>::max() ? generator() : UniformBelow(generator, span + 1);
+        return static_cast<std::int64_t>(static_cast<std::uint64_t>(min) + offset);
+    }
+
+    /**
+     * Seed drawn from the operating system's entropy source, for runs that do not have to be reproducible.
+     */
+    inline std::uint64_t RandomSeed()
+    {
+        std::random_device device;
+        return (static_cast<std::uint64_t>(device()) << 32) ^ device();
+    }
+}
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <span>
+#include <vector>
+
+namespace TerminalMinigames
+{
+    /**
+     * Double-ended queue with a fixed capacity that is allocated once up front.
+     * Pushing and popping never allocates, which keeps the elements in one contiguous block of memory.
+     */
+    template <typename T>
+    class RingBuffer
+    {
+    public:
+        /**
+         * Allocates storage for the given number of elements and clears the buffer.
+         * Only reallocates if the capacity changes.
+         *
+         * @param new_capacity Max number of elements the buffer can hold.
+         */
+        void Reserve(size_t new_capacity)
+        {
+            if (storage.size() != new_capacity)
+            {
+                storage.assign(new_capacity, T{});
+            }
+            Clear();
+        }
+
+        void Clear()
+        {
+            head = 0;
+            count = 0;
+        }
+
+        size_t Size() const
+        {
+            return count;
+        }
+
+        size_t Capacity() const
+        {
+            return storage.size();
+        }
+
+        bool Empty() const
+        {
+            return count == 0;
+        }
+
+        void PushFront(const T& value)
+        {
+            assert(count < storage.size());
+
+            head = head == 0 ? storage.size() - 1 : head - 1;
+            storage[head] = value;
+            ++count;
+        }
+
+        void PushBack(const T& value)
+        {
+            assert(count < storage.size());
+
+            storage[Wrap(head + count)] = value;
+            ++count;
+        }
+
+        void PopBack()
+        {
+            assert(count > 0);
+
+            --count;
+        }
+
+        const T& Front() const
+        {
+            return storage[head];
+        }
+
+        const T& Back() const
+        {
+            return storage[Wrap(head + count - 1)];
+        }
+
+        /**
+         * Returns the element at the given position counted from the front.
+         */
+        const T& operator[](size_t index) const
+        {
+            return storage[Wrap(head + index)];
+        }
+
+        /**
+         * Contiguous run of elements starting at the front.
+         * Together with SecondSegment() it covers all elements in order.
+         */
+        std::span<const T> FirstSegment() const
+        {
+            return std::span<const T>(storage.data() + head, std::min(count, storage.size() - head));
+        }
+
+        /**
+         * Contiguous run of the elements that wrapped around to the start of the storage.
+         */
+        std::span<const T> SecondSegment() const
+        {
+            return std::span<const T>(storage.data(), count - FirstSegment().size());
+        }
+
+    private:
+        size_t Wrap(size_t index) const
+        {
+            return index >= storage.size() ? index - storage.size() : index;
+        }
+
+        std::vector<T> storage;
+        size_t head = 0;
+        size_t count = 0;
+    };
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <optional>
+
+namespace TerminalMinigames
+{
+    /**
+     * Lock-free bounded queue for exactly one producer thread and one consumer thread.
+     * Each index is only written by one side, so pushing and popping need no locks and never block.
+     *
+     * @tparam T Element type.
+     * @tparam Capacity Number of slots. Must be a power of two.
+     */
+    template <typename T, size_t Capacity>
+    class SpscQueue
+    {
+        static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+    public:
+        /**
+         * Appends the given value. Must only be called from the producer thread.
+         *
+         * @returns Whether the value was added, i.e. false if the queue is full.
+         */
+        bool Push(const T& value)
+        {
+            size_t tail = write_index.load(std::memory_order_relaxed);
+            if (tail - read_index.load(std::memory_order_acquire) == Capacity)
+            {
+                return false;
+            }
+
+            slots[tail & (Capacity - 1)] = value;
+            write_index.store(tail + 1, std::memory_order_release);
+            return true;
+        }
+
+        /**
+         * Removes and returns the oldest value. Must only be called from the consumer thread.
+         */
+        std::optional<T> Pop()
+        {
+            size_t head = read_index.load(std::memory_order_relaxed);
+            if (head == write_index.load(std::memory_order_acquire))
+            {
+                return std::nullopt;
+            }
+
+            T value = slots[head & (Capacity - 1)];
+            read_index.store(head + 1, std::memory_order_release);
+            return value;
+        }
+
+        /**
+         * Drops all queued values. Must only be called from the consumer thread.
+         */
+        void Clear()
+        {
+            read_index.store(write_index.load(std::memory_order_acquire), std::memory_order_release);
+        }
+
+    private:
+        std::array<T, Capacity> slots{};
+
+        /**
+         * Indices only ever grow and are wrapped when accessing the slots.
+         * Kept on separate cache lines so the two threads do not invalidate each other's line.
+         */
+        alignas(64) std::atomic<size_t> write_index = 0;
+        alignas(64) std::atomic<size_t> read_index = 0;
+    };
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <stop_token>
+
+namespace TerminalMinigames
+{
+    /**
+     * Sleeps until the given deadline or until a stop is requested on the given token, whichever comes first.
+     *
+     * @returns Whether the deadline was reached without a stop being requested.
+     */
+    inline bool SleepUntil(std::stop_token stop, std::chrono::steady_clock::time_point deadline)
+    {
+        std::mutex mutex;
+        std::condition_variable_any wake;
+
+        std::unique_lock lock(mutex);
+        wake.wait_until(lock, stop, deadline, [] { return false; });
+
+        return !stop.stop_requested();
+    }
+}
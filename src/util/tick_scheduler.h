@@ -0,0 +1,69 @@
+#pragma once
+
+#include <chrono>
+
+#include "latency_stats.h"
+
+namespace TerminalMinigames
+{
+    /**
+     * Spaces ticks at absolute deadlines on the steady clock. Each deadline is one period after the previous deadline
+     * rather than after the previous wake-up, so the time spent on a tick and the scheduler latency do not add up over time.
+     */
+    class TickScheduler
+    {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        /**
+         * Starts counting deadlines from now and clears the jitter statistics.
+         */
+        void Start()
+        {
+            next_tick = Clock::now();
+            jitter = {};
+        }
+
+        /**
+         * Moves on to the deadline one period after the previous one.
+         *
+         * @param period Length of the upcoming tick.
+         * @returns Deadline to wait for before running the tick.
+         */
+        Clock::time_point NextTick(Clock::duration period)
+        {
+            next_tick += period;
+            return next_tick;
+        }
+
+        /**
+         * Records how late the wake-up for the current deadline was.
+         * If it was more than a whole period late, the missed deadlines are skipped instead of run in a burst.
+         *
+         * @param period Length of the current tick.
+         */
+        void RecordWakeUp(Clock::duration period)
+        {
+            auto now = Clock::now();
+            auto lateness = now - next_tick;
+            jitter.Record(std::chrono::duration<double, std::milli>(lateness).count());
+
+            if (lateness > period)
+            {
+                next_tick = now;
+            }
+        }
+
+        /**
+         * Lateness of the ticks compared to their deadlines.
+         */
+        const LatencyStats& Jitter() const
+        {
+            return jitter;
+        }
+
+    private:
+        Clock::time_point next_tick = Clock::now();
+        LatencyStats jitter;
+    };
+}